@@ -0,0 +1,9 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+uniform mat4 MVP;
+out vec3 lineColor;
+void main() {
+    lineColor = aColor;
+    gl_Position = MVP * vec4(aPos, 1.0);
+}
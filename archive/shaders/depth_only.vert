@@ -0,0 +1,10 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 MVP;
+
+// Depth pre-pass: position only, the same transform as the object shaders
+void main()
+{
+    gl_Position = MVP * vec4(aPos, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+
+out vec4 FragColor;
+
+#include "include/lighting.glsl"
+
+// Distant stand-in for hypno-eye and googly-eye: the pupil stays centred on the light
+// instead of moving with time, and there is no per-fragment trigonometry
+void main()
+{
+    vec3 norm = normalize(Normal);
+    float pupilDistance = 1.0 - dot(norm, lightDir);
+
+    vec3 baseColor = pupilDistance < 0.1 ? vec3(0.0)
+                   : pupilDistance < 0.2 ? vec3(0.2, 0.55, 0.55)
+                   : vec3(1.0);
+
+    FragColor = vec4(baseColor * max(dot(norm, lightDir), 0.15) * lightColor, 1.0);
+}
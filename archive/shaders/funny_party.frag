@@ -1,4 +1,5 @@
 #version 330 core
+// lod: basic_lit.vert basic_lit.frag 16  // Cheaper pair when the object is small on screen
 
 in vec3 FragPos;
 in vec3 Normal;
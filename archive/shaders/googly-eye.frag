@@ -1,4 +1,5 @@
 #version 330 core
+// lod: basic_lit.vert eye_lod.frag 20  // Cheaper pair when the object is small on screen
 
 in vec3 FragPos;
 in vec3 Normal;
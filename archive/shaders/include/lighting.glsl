@@ -0,0 +1,9 @@
+// Directional light uniforms set by Map::render
+uniform vec3 lightDir;    // e.g., vec3(0.5, 1.0, 0.3)
+uniform vec3 lightColor;  // e.g., vec3(1.0)
+uniform vec3 objectColor; // e.g., vec3(0.8, 0.2, 0.2)
+
+float lambert(vec3 normal)
+{
+    return max(dot(normalize(normal), normalize(lightDir)), 0.0);
+}
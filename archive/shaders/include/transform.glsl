@@ -0,0 +1,16 @@
+// Object-to-world and clip-space transform shared by the vertex shaders.
+// NO_MODEL: vertices are already in world space (voxel chunks) and only MVP is needed.
+#if defined(NO_MODEL)
+uniform mat4 MVP;
+
+vec4 clipPosition(vec3 pos) { return MVP * vec4(pos, 1.0); }
+vec3 worldPosition(vec3 pos) { return pos; }
+vec3 worldNormal(vec3 normal) { return normal; }
+#else
+uniform mat4 MVP;
+uniform mat4 model;
+
+vec4 clipPosition(vec3 pos) { return MVP * vec4(pos, 1.0); }
+vec3 worldPosition(vec3 pos) { return vec3(model * vec4(pos, 1.0)); }
+vec3 worldNormal(vec3 normal) { return mat3(transpose(inverse(model))) * normal; }  // Handles non-uniform scale
+#endif
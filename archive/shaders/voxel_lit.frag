@@ -0,0 +1,23 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 Light;
+
+out vec4 FragColor;
+
+#include "include/lighting.glsl"
+
+const vec3 blockLightColor = vec3(1.0, 0.8, 0.55);  // Warm light from Light blocks
+const float ambient = 0.25;
+
+void main()
+{
+    float diff = lambert(Normal);
+
+    // Light levels fall off faster than linearly so caves get properly dark
+    float sky = pow(Light.x, 2.2);
+    float block = pow(Light.y, 2.2);
+
+    vec3 light = sky * (ambient + diff) * lightColor + block * blockLightColor;
+    FragColor = vec4(light * objectColor, 1.0);
+}
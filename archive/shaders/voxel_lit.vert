@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aLight;  // Baked sky and block light, 0-1
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 Light;
+
+#include "include/transform.glsl"
+
+void main()
+{
+    gl_Position = clipPosition(aPos);
+    FragPos = worldPosition(aPos);
+    Normal = worldNormal(aNormal);
+    Light = aLight;
+}
@@ -4,11 +4,8 @@
 #include <ostream>
 #include <iostream>
 
-Mesh createCube(float size) {
-    Mesh mesh;
-
-    float h = size / 2.0f;
-    std::vector<float> vertices = {
+static std::vector<float> cubeVertices(float h) {
+    return {
         // Front face (+Z)
         -h, -h,  h,  0.0f, 0.0f, 1.0f,
          h, -h,  h,  0.0f, 0.0f, 1.0f,
@@ -57,6 +54,22 @@ Mesh createCube(float size) {
            -h, -h,  h, 0.0f, -1.0f, 0.0f,
             h, -h,  h, 0.0f, -1.0f, 0.0f,
     };
+}
+
+void appendBox(std::vector<float>& out, const glm::vec3& center, const glm::vec3& size) {
+    static const std::vector<float> unit = cubeVertices(0.5f);
+    for (size_t i = 0; i < unit.size(); i += 6) {
+        out.insert(out.end(), {
+            center.x + unit[i] * size.x, center.y + unit[i + 1] * size.y, center.z + unit[i + 2] * size.z,
+            unit[i + 3], unit[i + 4], unit[i + 5]
+        });
+    }
+}
+
+Mesh createCube(float size) {
+    Mesh mesh;
+
+    std::vector<float> vertices = cubeVertices(size / 2.0f);
 
     mesh.setVertices(vertices);  //  Use this instead of accessing mesh.vertices directly
     return mesh;
@@ -280,6 +293,8 @@ Mesh ShapeFactory::createShape(const std::string& type) {
         return createPyramid(1.0f);
     } else if (type == "HexPrism") {
         return createHexPrism(0.5f, 1.0f);  // Example: radius = 0.5, height = 1.0
+    } else if (type == "Floor" || type == "WidthWall" || type == "DepthWall") {
+        return createCube(1.0f);  // Unit cube, sized by the object's scale
     } else {
         std::cerr << "Unknown shape type: " << type << std::endl;
         return Mesh();  // empty mesh
@@ -13,6 +13,8 @@ Mesh createPyramid(float size);
 Mesh createCube(float size);
 Mesh createSphere(float radius, int sectors, int stacks);
 Mesh createHexPrism(float radius, float height);
+// Appends a box as 36 vertices (3 pos + 3 normal), for meshes built out of many boxes
+void appendBox(std::vector<float>& out, const glm::vec3& center, const glm::vec3& size);
 
 // Central mesh generation dispatch
 Mesh generateMeshForType(const std::string& type, float scale);
@@ -13,8 +13,26 @@
 #include <string>
 #include <GLFW/glfw3.h>
 #include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <chrono>
 #include "mazeGen.h"
+#include "mazeAlgorithms.h"
+#include "mazeStream.h"
+#include "mazeLevels.h"
+#include "pathfinding.h"
 #include "voxel.h"
+#include "voxelRenderer.h"
+#include "voxelRaycast.h"
+#include "voxelBrush.h"
+#include "voxelLight.h"
+#include "voxelWater.h"
+#include "voxelFile.h"
+#include "debugDraw.h"
+#include "shaderWatcher.h"
+#include "dynamicResolution.h"
+#include "gpuProfiler.h"
 
 static char mapFilename[128] = "default.txt";
 static bool showSavePopup = false;
@@ -22,6 +40,9 @@ static bool showLoadPopup = false;
 static Map mapBuffer;
 //Tracks loaded map filename
 static std::string loadedMapFilename = "";
+// The voxel map is saved next to a map file as "<map>.lvox", since the map savers skip voxel chunks
+static void SaveMapVoxels(const std::string& mapPath);
+static void LoadMapVoxels(const std::string& mapPath);
 
 // Place this near the top of UI.cpp
 static std::vector<std::string> shaderBaseNames;
@@ -134,6 +155,7 @@ void UI::RenderMainMenuBar(Map& mapBuffer, GLFWwindow* window) {
                     std::cerr << "Failed to save binary map to: " << fullPath << std::endl;
                 }
             }
+            SaveMapVoxels(fullPath);
 
             loadedMapFilename = fullPath;
 
@@ -157,6 +179,7 @@ void UI::RenderMainMenuBar(Map& mapBuffer, GLFWwindow* window) {
             std::string filenameStr = std::string(mapFilename);
             std::string fullPath = "Maps/" + filenameStr;
 
+            StopMazeStream(mapBuffer);  // Its chunks go with the clear
             mapBuffer.clear();  //  Clear buffer BEFORE loading
 
             bool success = false;
@@ -169,6 +192,7 @@ void UI::RenderMainMenuBar(Map& mapBuffer, GLFWwindow* window) {
 
             if (success) {
                 loadedMapFilename = fullPath;
+                LoadMapVoxels(fullPath);
                 std::cout << "Map loaded from: " << fullPath << std::endl;
             }
             else {
@@ -193,8 +217,178 @@ void UI::RenderCameraDebugWindow() {
     ImGui::Checkbox("Invert Pitch", &camera.invertPitch);
     ImGui::Checkbox("Use Camera Light", &camera.useCameraLight);
     ImGui::Checkbox("Show Grid", &camera.showGrid);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Shader LOD", &mapBuffer.useShaderLods);
+    ImGui::SliderFloat("LOD Scale", &mapBuffer.lodScale, 0.25f, 4.0f);  // Higher switches sooner
+    ImGui::Text("Objects on LOD shaders: %d / %zu", mapBuffer.lodObjectCount, mapBuffer.objects.size());
+
+    ImGui::Separator();
+    ImGui::Checkbox("Depth Pre-Pass", &mapBuffer.depthPrePass);
+    ImGui::Text("Frame time: %.2f ms (%.0f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+    ImGui::Separator();
+    DynamicResolution::Settings& resolution = DynamicResolution::GetSettings();
+    ImGui::Checkbox("Dynamic Resolution", &resolution.enabled);
+    ImGui::Checkbox("Adapt to Budget", &resolution.adaptive);
+    ImGui::SliderFloat("GPU Budget (ms)", &resolution.targetMs, 2.0f, 50.0f, "%.1f");
+    ImGui::SliderFloat("Min Scale", &resolution.minScale, 0.25f, 1.0f, "%.2f");
+    ImGui::SliderFloat("Max Scale", &resolution.maxScale, 0.25f, 1.0f, "%.2f");
+    ImGui::SliderFloat("Scale", &resolution.scale, resolution.minScale, resolution.maxScale, "%.2f");
+    ImGui::Text("Scene GPU time: %.2f ms", DynamicResolution::LastGpuMs());
+    ImGui::End();
+}
+
+void UI::RenderGpuProfiler() {
+    ImGui::Begin("GPU Profiler");
+    ImGui::Checkbox("Timer Queries", &GpuProfiler::Enabled());
+    ImGui::SameLine();
+    ImGui::TextDisabled("(last %d frames)", GpuProfiler::HISTORY);
+
+    if (ImGui::BeginTable("Passes", 9, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        for (const char* header : { "Pass", "Avg ms", "p50", "p95", "p99", "Max", "Draws", "Triangles", "State" })
+            ImGui::TableSetupColumn(header);
+        ImGui::TableHeadersRow();
+
+        GpuProfiler::PassStats total;
+        for (int pass = 0; pass < GpuProfiler::PASS_COUNT; ++pass) {
+            GpuProfiler::PassStats stats = GpuProfiler::GetPassStats(pass);
+            total.averageMs += stats.averageMs;
+            total.drawCalls += stats.drawCalls;
+            total.triangles += stats.triangles;
+            total.stateChanges += stats.stateChanges;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(GpuProfiler::PassName(pass));
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.averageMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p50Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p95Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p99Ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.maxMs);
+            ImGui::TableNextColumn(); ImGui::Text("%d", stats.drawCalls);
+            ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(stats.triangles));
+            ImGui::TableNextColumn(); ImGui::Text("%d", stats.stateChanges);
+        }
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted("Total");
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", total.averageMs);
+        for (int column = 0; column < 4; ++column)
+            ImGui::TableNextColumn();
+        ImGui::TableNextColumn(); ImGui::Text("%d", total.drawCalls);
+        ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(total.triangles));
+        ImGui::TableNextColumn(); ImGui::Text("%d", total.stateChanges);
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+#if CPU_PROFILER_ENABLED
+static ImU32 zoneColor(const char* name) {
+    uint32_t hash = 2166136261u;  // FNV-1a, so a zone keeps its colour between frames
+    for (const char* c = name; *c; ++c)
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    return IM_COL32(90 + (hash & 0x7F), 90 + ((hash >> 8) & 0x7F), 90 + ((hash >> 16) & 0x7F), 255);
+}
+
+void UI::RenderCpuProfiler() {
+    static bool paused = false;
+    static int framesShown = 1;
+    static char tracePath[128] = "profile.json";
+    static std::vector<CpuProfiler::ThreadEvents> threads;
+    static int64_t rangeStart = 0, rangeEnd = 0;
+
+    ImGui::Begin("CPU Profiler");
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderInt("Frames", &framesShown, 1, 10);
+    ImGui::SetNextItemWidth(200);
+    ImGui::InputText("##TracePath", tracePath, IM_ARRAYSIZE(tracePath));
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace"))
+        CpuProfiler::ExportChromeTrace(tracePath);
+
+    // The last framesShown complete frames, between frame marks
+    if (!paused) {
+        std::vector<int64_t> frames = CpuProfiler::FrameStarts();
+        if (static_cast<int>(frames.size()) > framesShown) {
+            rangeEnd = frames.back();
+            rangeStart = frames[frames.size() - 1 - framesShown];
+            threads = CpuProfiler::Snapshot(rangeStart);
+        }
+    }
+    if (rangeEnd <= rangeStart) {
+        ImGui::TextUnformatted("Waiting for frames...");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("%.2f ms shown", (rangeEnd - rangeStart) / 1.0e6);
+
+    // Timeline: one band per thread, a row per nesting depth
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    const double pixelsPerNs = width / static_cast<double>(rangeEnd - rangeStart);
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    std::unordered_map<std::string, std::pair<int, int64_t>> totals;  // Calls and time per zone
+
+    for (const CpuProfiler::ThreadEvents& thread : threads) {
+        uint32_t maxDepth = 0;
+        bool any = false;
+        for (const CpuProfiler::ZoneEvent& e : thread.events) {
+            if (e.start >= rangeEnd || e.end < rangeStart) continue;
+            maxDepth = std::max(maxDepth, e.depth);
+            any = true;
+        }
+        if (!any) continue;
+
+        ImGui::TextUnformatted(thread.threadName.c_str());
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float bandHeight = rowHeight * (maxDepth + 1);
+        ImGui::Dummy(ImVec2(width, bandHeight));
+        drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + bandHeight), true);
+        for (const CpuProfiler::ZoneEvent& e : thread.events) {
+            if (e.start >= rangeEnd || e.end < rangeStart) continue;
+            const int64_t start = std::max(e.start, rangeStart), end = std::min(e.end, rangeEnd);
+            auto& total = totals[e.name];
+            ++total.first;
+            total.second += end - start;
+
+            ImVec2 a(origin.x + static_cast<float>((start - rangeStart) * pixelsPerNs), origin.y + e.depth * rowHeight);
+            ImVec2 b(std::max(a.x + 1.0f, origin.x + static_cast<float>((end - rangeStart) * pixelsPerNs)), a.y + rowHeight - 1.0f);
+            drawList->AddRectFilled(a, b, zoneColor(e.name));
+            if (b.x - a.x > 40.0f) {
+                drawList->PushClipRect(a, b, true);
+                drawList->AddText(ImVec2(a.x + 2.0f, a.y + 2.0f), IM_COL32(0, 0, 0, 255), e.name);
+                drawList->PopClipRect();
+            }
+            if (ImGui::IsItemHovered() && mouse.x >= a.x && mouse.x < b.x && mouse.y >= a.y && mouse.y < b.y)
+                ImGui::SetTooltip("%s\n%.3f ms", e.name, (e.end - e.start) / 1.0e6);
+        }
+        drawList->PopClipRect();
+    }
+
+    // Zones by total time over the shown frames, all threads together
+    std::vector<std::pair<std::string, std::pair<int, int64_t>>> sorted(totals.begin(), totals.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second.second > b.second.second; });
+    if (ImGui::BeginTable("Zones", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Total ms");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < sorted.size() && i < 20; ++i) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(sorted[i].first.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%d", sorted[i].second.first);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", sorted[i].second.second / 1.0e6);
+        }
+        ImGui::EndTable();
+    }
     ImGui::End();
 }
+#endif
 
 void UI::RenderMapEditor(Map& mapBuffer) {
     ImGui::Begin("Map Editor");
@@ -470,6 +664,23 @@ void UI::RenderShaderUtility(const glm::mat4& mvp) {
 
         ImGui::Begin("Shader Utility");
 
+        const ShaderCacheStats& cacheStats = GetShaderCacheStats();
+        ImGui::Text("Programs: %d from binary cache, %d compiled, %d rejected binaries, %d failed",
+                    cacheStats.fromCache, cacheStats.compiled, cacheStats.rejected, cacheStats.failed);
+        if (PendingShaderCompiles() > 0)
+            ImGui::Text("%d programs compiling", PendingShaderCompiles());
+
+        // Saved shader files recompile only the programs that use them
+        bool watching = ShaderWatcherRunning();
+        if (ImGui::Checkbox("Hot Reload", &watching)) {
+            if (watching)
+                StartShaderWatcher(shaderDir);
+            else
+                StopShaderWatcher();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%s)", ShaderWatcherMode());
+
         // === Shader File Dropdown ===
         if (ImGui::BeginCombo("Shader Files", selectedIndex >= 0 ? shaders[selectedIndex].filename().string().c_str() : "Select Shader")) {
             for (int i = 0; i < shaders.size(); ++i) {
@@ -505,12 +716,7 @@ void UI::RenderShaderUtility(const glm::mat4& mvp) {
             // === Reload Button ===
             ImGui::SameLine();
             if (ImGui::Button("Reload Shader")) {
-                GLuint newProgram = createShaderProgramFromFile("basic.vert", "basic.frag");
-                if (newProgram != 0) {
-                    glDeleteProgram(shaderProgram);
-                    shaderProgram = newProgram;
-                    glUseProgram(shaderProgram);
-                }
+                ReloadShadersUsing({ currentShaderPath.filename().string() });
             }
 
             // === Archive Button ===
@@ -534,7 +740,10 @@ void UI::RenderMazeGenerator(Map& mapBuffer) {
     static float floorHeight = 0.0f;  // Default Y position of the floor
     static std::string selectedShaderBase = "basic";
     static bool addOpenSpaces = false;
-    static bool useDiagonal = false;
+    static int mazeAlgorithm = 0;  // Index into MazeAlgorithms()
+    static int mazeSeed = 1;  // Same seed, same maze
+    static int mazeLevels = 1;  // Stacked levels joined by stairwells
+    static float levelHeight = 1.5f;
 
 
     ImGui::Begin("Maze Generator");
@@ -543,8 +752,23 @@ void UI::RenderMazeGenerator(Map& mapBuffer) {
     ImGui::InputInt("Maze Depth", &mazeDepth, 1, 50);
     ImGui::InputFloat("Cell Size", &cellSize, 0.5f, 10.0f);
     ImGui::InputFloat("Floor Height", &floorHeight, -5.0f, 5.0f);  // Add this below cellSize
+    ImGui::SliderInt("Levels", &mazeLevels, 1, 64);
+    if (mazeLevels > 1)
+        ImGui::InputFloat("Level Height", &levelHeight, 0.1f, 1.0f);
     ImGui::Checkbox("Add Random Open Spaces", &addOpenSpaces);
-    ImGui::Checkbox("Allow Diagonal Carving", &useDiagonal);
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    if (ImGui::BeginCombo("Algorithm", algorithms[mazeAlgorithm]->name())) {
+        for (int i = 0; i < static_cast<int>(algorithms.size()); ++i) {
+            if (ImGui::Selectable(algorithms[i]->name(), i == mazeAlgorithm))
+                mazeAlgorithm = i;
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::InputInt("Seed", &mazeSeed);
+    ImGui::SameLine();
+    if (ImGui::Button("Random Seed")) {
+        mazeSeed = static_cast<int>(std::random_device{}() & 0x7fffffff);
+    }
 
 
 
@@ -566,9 +790,123 @@ void UI::RenderMazeGenerator(Map& mapBuffer) {
     }
 
     if (ImGui::Button("Generate Maze")) {
-    GenerateMaze(mapBuffer, mazeWidth, mazeDepth, cellSize,
-                 floorHeight, selectedShaderBase, addOpenSpaces);
+    StopMazeStream(mapBuffer);
+    if (mazeLevels > 1)
+        GenerateMazeLevels(mapBuffer, mazeWidth, mazeDepth, mazeLevels, cellSize, floorHeight, levelHeight,
+                           selectedShaderBase, addOpenSpaces, static_cast<uint32_t>(mazeSeed), mazeAlgorithm);
+    else
+        GenerateMaze(mapBuffer, mazeWidth, mazeDepth, cellSize,
+                     floorHeight, selectedShaderBase, addOpenSpaces, static_cast<uint32_t>(mazeSeed), mazeAlgorithm);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Maze")) {
+        BenchmarkMazeGeneration();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Algorithms")) {
+        BenchmarkMazeAlgorithms();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Merging")) {
+        BenchmarkMazeMerging();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Levels")) {
+        BenchmarkMazeLevels();
+    }
+
+    // Eller's algorithm: Maze Width columns, rows generated along +z as the camera moves
+    ImGui::Separator();
+    ImGui::Text("Streaming Maze");
+    ImGui::SliderInt("Rows Ahead", &mazeStreamRowsAhead, MAZE_STREAM_CHUNK_ROWS, 512);
+    ImGui::SliderInt("Rows Behind", &mazeStreamRowsBehind, 0, 512);
+    if (!MazeStreamActive()) {
+        if (ImGui::Button("Start Streaming")) {
+            StartMazeStream(mapBuffer, mazeWidth, cellSize, floorHeight, selectedShaderBase,
+                            static_cast<uint32_t>(mazeSeed));
+        }
+    } else {
+        if (ImGui::Button("Stop Streaming")) {
+            StopMazeStream(mapBuffer);
+        }
+        ImGui::SameLine();
+        ImGui::Text("%lld rows generated", MazeStreamRows());
+    }
+    UpdateMazeStream(mapBuffer, camera.getPosition());
+
+    // Solves the maze the settings above describe (re-carved from the seed) or the map's floors
+    static int pathSource = 0;  // 0 = maze grid, 1 = map walkability
+    static float navResolution = 0.25f;
+    static int pathMethod = 0;  // A*, JPS, flow field
+    static int pathStart[2] = { 0, 0 };
+    static int pathGoal[2] = { 4, 4 };
+    static bool showPath = true;
+    static bool showFlowField = false;
+    static NavGrid navGrid;
+    static PathResult path;
+    static FlowField flowField;
+    static double pathMs = 0.0;
+
+    ImGui::Separator();
+    ImGui::Text("Pathfinding");
+    ImGui::RadioButton("Maze Grid", &pathSource, 0);
+    ImGui::SameLine();
+    ImGui::RadioButton("Map", &pathSource, 1);
+    if (pathSource == 1)
+        ImGui::InputFloat("Resolution", &navResolution, 0.05f, 0.25f);
+    const char* pathMethods[] = { "A*", "Jump Point Search", "Flow Field" };
+    ImGui::Combo("Method", &pathMethod, pathMethods, IM_ARRAYSIZE(pathMethods));
+    ImGui::InputInt2("Start Cell", pathStart);
+    ImGui::InputInt2("Goal Cell", pathGoal);
+
+    auto buildNavGrid = [&]() {
+        if (pathSource == 0)
+            navGrid = NavGridFromMaze(CarveMazeGrid(mazeWidth, mazeDepth, addOpenSpaces, static_cast<uint32_t>(mazeSeed),
+                                                    mazeAlgorithm), cellSize, floorHeight);
+        else
+            navGrid = NavGridFromMap(mapBuffer, navResolution, floorHeight);
+        flowField = FlowField();
+    };
+    if (ImGui::Button("Solve")) {
+        buildNavGrid();
+        const glm::ivec2 start(pathStart[0], pathStart[1]), goal(pathGoal[0], pathGoal[1]);
+        auto begin = std::chrono::steady_clock::now();
+        if (pathMethod == 0) {
+            path = FindPathAStar(navGrid, start, goal);
+        } else if (pathMethod == 1) {
+            path = FindPathJPS(navGrid, start, goal);
+        } else {
+            ComputeFlowField(navGrid, goal, flowField, GetJobSystem());
+            path = flowField.follow(start);
+        }
+        pathMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Critical Path")) {
+        buildNavGrid();
+        auto begin = std::chrono::steady_clock::now();
+        path = FindCriticalPath(navGrid, glm::ivec2(0), GetJobSystem());
+        pathMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Pathfinding")) {
+        BenchmarkPathfinding();
     }
+    ImGui::Text("Grid %d x %d: %s", navGrid.width(), navGrid.depth(),
+                path.found ? "path found" : "no path");
+    if (path.found)
+        ImGui::Text("Length %d cells, %zu nodes expanded, %.2f ms", path.length(), path.expanded, pathMs);
+    if (flowField.width > 0)
+        ImGui::Text("%zu cells can reach the goal", flowField.reachable);
+    ImGui::Checkbox("Show Path", &showPath);
+    ImGui::SameLine();
+    ImGui::Checkbox("Show Flow Field", &showFlowField);
+
+    if (showPath && path.found)
+        DrawPath(navGrid, path, glm::vec3(1.0f, 0.9f, 0.1f));
+    // One line per cell, so only small fields are drawn
+    if (showFlowField && static_cast<size_t>(flowField.width) * flowField.depth <= 128 * 128)
+        DrawFlowField(navGrid, flowField);
 
     ImGui::End();
 }
@@ -577,16 +915,134 @@ void UI::RenderMazeGenerator(Map& mapBuffer) {
 static VoxelMap voxelMap;
 static int selectedX = 0, selectedY = 0, selectedZ = 0;
 static VoxelType currentType = VoxelType::Solid;
+// Requested size; only applied to voxelMap on resize so chunk tables match the storage
+static int voxelWidth = 0, voxelHeight = 1, voxelDepth = 0;
+static char voxelFilename[128] = "voxels.lvox";
+static bool cursorEditing = true;
+
+static void SaveMapVoxels(const std::string& mapPath) {
+    const std::string path = mapPath + ".lvox";
+    bool hasVoxels = false;
+    for (int cz = 0; cz < voxelMap.chunksZ() && !hasVoxels; ++cz)
+        for (int cy = 0; cy < voxelMap.chunksY() && !hasVoxels; ++cy)
+            for (int cx = 0; cx < voxelMap.chunksX() && !hasVoxels; ++cx)
+                hasVoxels = !voxelMap.isChunkEmpty(cx, cy, cz);
+    if (!hasVoxels) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);  // A stale file would bring old voxels back on load
+        return;
+    }
+    if (!voxelMap.saveToFile(path))
+        std::cerr << "Failed to save voxels to: " << path << std::endl;
+}
+
+static void LoadMapVoxels(const std::string& mapPath) {
+    const std::string path = mapPath + ".lvox";
+    if (!std::filesystem::exists(path))
+        return;
+    if (!voxelMap.loadFromFile(path)) {
+        std::cerr << "Failed to load voxels from: " << path << std::endl;
+        return;
+    }
+    voxelWidth = voxelMap.width;
+    voxelHeight = voxelMap.height;
+    voxelDepth = voxelMap.depth;
+    GenerateVoxelObjects(voxelMap, mapBuffer);
+}
+
+// Brush applied by Apply Brush and by cursor clicks; "Single" edits one cell
+enum class BrushShape { Single, Box, Sphere, Cylinder };
+static BrushShape brushShape = BrushShape::Single;
+static int brushSize = 3;  // Box edge, sphere radius or cylinder radius/height, in cells
+static VoxelRegion voxelClipboard;
+static const char* voxelShaderBase = "voxel_lit";  // Reads the light baked into chunk vertices
+
+static void ApplyBrush(int x, int y, int z, VoxelBlend blend) {
+    const Voxel voxel{ currentType, voxelShaderBase };
+    const glm::vec3 center = voxelMap.cellCenter(x, y, z);
+    const float radius = brushSize * voxelMap.voxelSize;
+    switch (brushShape) {
+    case BrushShape::Single:
+        if (voxelMap.inBounds(x, y, z))
+            voxelMap.setVoxel(x, y, z, blend == VoxelBlend::Subtract ? Voxel{ VoxelType::Empty, "basic" } : voxel);
+        break;
+    case BrushShape::Box:
+        FillVoxelBox(voxelMap, x, y, z, x + brushSize - 1, y + brushSize - 1, z + brushSize - 1, voxel, blend);
+        break;
+    case BrushShape::Sphere:
+        FillVoxelSphere(voxelMap, center, radius, voxel, blend);
+        break;
+    case BrushShape::Cylinder:
+        FillVoxelCylinder(voxelMap, center, radius, radius, voxel, blend);
+        break;
+    }
+}
+
+// Outlines one cell in the overlay drawn after the map
+static void OutlineVoxelCell(const VoxelMap& vmap, int x, int y, int z, const glm::vec3& color) {
+    const glm::vec3 center = vmap.cellCenter(x, y, z);
+    const float half = vmap.voxelSize * 0.5f * 1.02f;  // Slightly oversized so the lines are not z-fighting
+    if (vmap.layout == VoxelLayout::Hex)
+        DebugDraw::HexPrism(center, half, half, color);
+    else
+        DebugDraw::Box(center, glm::vec3(half), color);
+}
+
+// Casts the cursor ray into the voxel map, outlines the target and applies right-click edits.
+// Right-click places the current type against the hovered face, Ctrl+right-click removes.
+static void UpdateVoxelCursor() {
+    ImGuiIO& io = ImGui::GetIO();
+    if (!cursorEditing || io.WantCaptureMouse || io.DisplaySize.x <= 0.0f || io.DisplaySize.y <= 0.0f)
+        return;
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), io.DisplaySize.x / io.DisplaySize.y, 0.1f, 100.0f);
+    glm::vec3 origin, direction;
+    CursorRay(camera.getViewMatrix(), projection, io.MousePos.x, io.MousePos.y,
+              io.DisplaySize.x, io.DisplaySize.y, origin, direction);
+
+    VoxelRayHit hit = RaycastVoxels(voxelMap, origin, direction, 100.0f);
+    int placeX = hit.prevX, placeY = hit.prevY, placeZ = hit.prevZ;
+    bool canPlace = hit.hit && voxelMap.inBounds(placeX, placeY, placeZ) && !voxelMap.isSolid(placeX, placeY, placeZ);
+    if (!hit.hit && direction.y < 0.0f) {
+        // Nothing hit: fall back to the bottom layer so an empty map can still be painted
+        float t = (-0.5f * voxelMap.voxelSize - origin.y) / direction.y;
+        voxelMap.worldToCell(origin + direction * t, placeX, placeY, placeZ);
+        placeY = 0;
+        canPlace = voxelMap.inBounds(placeX, placeY, placeZ);
+    }
+
+    if (hit.hit)
+        OutlineVoxelCell(voxelMap, hit.x, hit.y, hit.z, glm::vec3(1.0f, 0.85f, 0.2f));
+    if (canPlace && !io.KeyCtrl)
+        OutlineVoxelCell(voxelMap, placeX, placeY, placeZ, glm::vec3(0.3f, 1.0f, 0.4f));
+
+    if (!ImGui::IsMouseClicked(1))
+        return;
+    if (io.KeyCtrl) {
+        if (hit.hit)
+            ApplyBrush(hit.x, hit.y, hit.z, VoxelBlend::Subtract);
+    } else if (canPlace) {
+        ApplyBrush(placeX, placeY, placeZ, VoxelBlend::Union);
+    }
+}
 
 void UI::RenderVoxelEditor(Map& mapBuffer) {
     ImGui::Begin("Voxel Editor");
 
-    ImGui::InputInt("Width", &voxelMap.width);
-    ImGui::InputInt("Height", &voxelMap.height);  // Added height control
-    ImGui::InputInt("Depth", &voxelMap.depth);
+    ImGui::InputInt("Width", &voxelWidth);
+    ImGui::InputInt("Height", &voxelHeight);  // Added height control
+    ImGui::InputInt("Depth", &voxelDepth);
     ImGui::InputFloat("Voxel Size", &voxelMap.voxelSize);
+
+    const char* layoutLabels[] = { "Cube", "Hex" };
+    int layout = static_cast<int>(voxelMap.layout);
+    if (ImGui::Combo("Layout", &layout, layoutLabels, IM_ARRAYSIZE(layoutLabels))) {
+        voxelMap.layout = static_cast<VoxelLayout>(layout);
+        GenerateVoxelObjects(voxelMap, mapBuffer);  // Cell positions and neighbours changed
+    }
     if (ImGui::Button("Resize Voxel Map")) {
-        voxelMap.resize(voxelMap.width, voxelMap.height, voxelMap.depth);
+        voxelMap.resize(std::max(voxelWidth, 0), std::max(voxelHeight, 0), std::max(voxelDepth, 0));
+        GenerateVoxelObjects(voxelMap, mapBuffer);  // Drop chunks from the old size
     }
 
     ImGui::Separator();
@@ -598,17 +1054,130 @@ void UI::RenderVoxelEditor(Map& mapBuffer) {
     ImGui::SliderInt("Z", &selectedZ, 0, voxelMap.depth - 1);
 
     // Voxel type selection
-    const char* typeLabels[] = { "Empty", "Solid", "Floor", "Water" };
+    const char* typeLabels[] = { "Empty", "Solid", "Floor", "Water", "Light" };
     int current = static_cast<int>(currentType);
     if (ImGui::Combo("Voxel Type", &current, typeLabels, IM_ARRAYSIZE(typeLabels)))
         currentType = static_cast<VoxelType>(current);
 
-    if (ImGui::Button("Place Voxel")) {
-        voxelMap.voxels[selectedZ][selectedY][selectedX].type = currentType;
-        GenerateVoxelObjects(voxelMap, mapBuffer);  // Rebuild map mesh
+    if (ImGui::Button("Place Voxel") && voxelMap.inBounds(selectedX, selectedY, selectedZ)) {
+        Voxel voxel = voxelMap.getVoxel(selectedX, selectedY, selectedZ);
+        voxel.type = currentType;
+        voxel.shaderBase = voxelShaderBase;
+        voxelMap.setVoxel(selectedX, selectedY, selectedZ, voxel);  // Marks the touched chunks dirty
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Brushes");
+    const char* brushLabels[] = { "Single", "Box", "Sphere", "Cylinder" };
+    int shape = static_cast<int>(brushShape);
+    if (ImGui::Combo("Brush", &shape, brushLabels, IM_ARRAYSIZE(brushLabels)))
+        brushShape = static_cast<BrushShape>(shape);
+    ImGui::SliderInt("Brush Size", &brushSize, 1, 64);
+    if (ImGui::Button("Add Brush"))
+        ApplyBrush(selectedX, selectedY, selectedZ, VoxelBlend::Union);
+    ImGui::SameLine();
+    if (ImGui::Button("Subtract Brush"))
+        ApplyBrush(selectedX, selectedY, selectedZ, VoxelBlend::Subtract);
+    ImGui::SameLine();
+    if (ImGui::Button("Flood Fill"))
+        FloodFillVoxels(voxelMap, selectedX, selectedY, selectedZ, Voxel{ currentType, voxelShaderBase });
+
+    // Clipboard uses the Box brush extent starting at the selected cell
+    if (ImGui::Button("Copy Region")) {
+        voxelClipboard = CopyVoxelRegion(voxelMap, selectedX, selectedY, selectedZ, selectedX + brushSize - 1,
+                                         selectedY + brushSize - 1, selectedZ + brushSize - 1);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Paste"))
+        PasteVoxelRegion(voxelMap, voxelClipboard, selectedX, selectedY, selectedZ, VoxelBlend::Replace);
+    ImGui::SameLine();
+    if (ImGui::Button("Paste Union"))
+        PasteVoxelRegion(voxelMap, voxelClipboard, selectedX, selectedY, selectedZ, VoxelBlend::Union);
+    ImGui::SameLine();
+    if (ImGui::Button("Paste Subtract"))
+        PasteVoxelRegion(voxelMap, voxelClipboard, selectedX, selectedY, selectedZ, VoxelBlend::Subtract);
+    if (ImGui::Button("Benchmark Brushes")) {
+        BenchmarkVoxelBrushes();
+    }
+
+    ImGui::Separator();
+    ImGui::Checkbox("Edit With Cursor", &cursorEditing);
+    ImGui::TextDisabled("Right-click: add brush, Ctrl+Right-click: subtract brush");
+    if (ImGui::Button("Benchmark Raycast")) {
+        BenchmarkVoxelRaycast(voxelMap);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Lighting")) {
+        BenchmarkVoxelLighting();
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Water");
+    ImGui::Checkbox("Simulate Water", &voxelWaterEnabled);
+    ImGui::SliderInt("Water Ticks / Second", &voxelWaterTickRate, 1, 60);
+    int waterChunks = 0;
+    size_t waterCellsChanged = 0;
+    VoxelWaterStats(waterChunks, waterCellsChanged);
+    ImGui::Text("Active water chunks: %d, cells changed last tick: %zu", waterChunks, waterCellsChanged);
+    if (ImGui::Button("Benchmark Water")) {
+        BenchmarkVoxelWater();
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Voxel File (in Maps/)");
+    ImGui::InputText("##VoxelFilename", voxelFilename, IM_ARRAYSIZE(voxelFilename));
+    if (ImGui::Button("Save Voxels")) {
+        if (!voxelMap.saveToFile("Maps/" + std::string(voxelFilename))) {
+            std::cerr << "Failed to save voxels to: Maps/" << voxelFilename << std::endl;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load Voxels")) {
+        std::string fullPath = "Maps/" + std::string(voxelFilename);
+        if (voxelMap.loadFromFile(fullPath)) {
+            voxelWidth = voxelMap.width;
+            voxelHeight = voxelMap.height;
+            voxelDepth = voxelMap.depth;
+            GenerateVoxelObjects(voxelMap, mapBuffer);
+            std::cout << "Voxels loaded from: " << fullPath << std::endl;
+        } else {
+            std::cerr << "Failed to load voxels from: " << fullPath << std::endl;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark Round Trip")) {
+        BenchmarkVoxelFileRoundTrip();
     }
 
+    ImGui::Separator();
+    ImGui::Text("Chunk Meshing");
+    ImGui::SliderInt("Uploads / Frame", &voxelUploadBudget, 1, 256);
+    ImGui::Text("Chunks meshing in background: %d", PendingVoxelChunkJobs());
+    if (ImGui::Button("Benchmark Meshing")) {
+        BenchmarkChunkMeshing(voxelMap);
+    }
+
+    ImGui::Checkbox("Level of Detail", &voxelLodEnabled);
+    ImGui::SliderFloat("LOD Distance", &voxelLodDistance, 4.0f, 100.0f);
+    ImGui::SliderFloat("LOD Hysteresis", &voxelLodHysteresis, 0.0f, 0.5f);
+    if (voxelMap.layout == VoxelLayout::Hex)
+        ImGui::TextDisabled("LOD applies to the cube layout only");
+    int chunksPerLevel[VOXEL_LOD_LEVELS];
+    size_t voxelTriangles = 0;
+    VoxelLodStats(chunksPerLevel, voxelTriangles);
+    ImGui::Text("Chunks at 1x/2x/4x/8x: %d / %d / %d / %d", chunksPerLevel[0], chunksPerLevel[1],
+                chunksPerLevel[2], chunksPerLevel[3]);
+    ImGui::Text("Voxel triangles: %zu", voxelTriangles);
+
     ImGui::End();
+
+    UpdateVoxelCursor();
+    // Reads this frame's edits before UpdateVoxelObjects takes them for relighting
+    UpdateVoxelWater(voxelMap, ImGui::GetIO().DeltaTime);
+
+    // Remesh only the chunks edited this frame (or whose level of detail changed)
+    UpdateVoxelLod(voxelMap, camera.getPosition());
+    UpdateVoxelObjects(voxelMap, mapBuffer);
 }
 
 
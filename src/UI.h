@@ -4,6 +4,7 @@
 #include "map.h"
 #include "shader_utility.h"
 #include "voxel.h"
+#include "cpuProfiler.h"
 
 class Map;
 struct GLFWwindow;
@@ -17,6 +18,10 @@ namespace UI {
     void RenderMazeGenerator(Map& mapBuffer);
     void RenderShaderUtility(const glm::mat4& mvp);
     void RenderCameraDebugWindow();
+    void RenderGpuProfiler();  // Per-pass GPU times and draw counts (gpuProfiler.h)
+#if CPU_PROFILER_ENABLED
+    void RenderCpuProfiler();  // Zone timeline and trace export (cpuProfiler.h)
+#endif
     void RenderVoxelEditor(Map& mapBuffer);
 
 
@@ -0,0 +1,179 @@
+#include "cpuProfiler.h"
+
+#if CPU_PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+constexpr size_t RING_EVENTS = 1 << 15;  // Per thread, about 768 KB
+constexpr int MAX_DEPTH = 64;
+constexpr size_t FRAME_MARKS = 512;
+
+const auto profilerStart = std::chrono::steady_clock::now();
+
+// Written only by its own thread. Readers copy the ring and then drop whatever the writer may
+// have overwritten meanwhile, so recording never waits for a reader.
+struct ThreadBuffer {
+    uint32_t threadId = 0;
+    std::string threadName;
+    std::unique_ptr<CpuProfiler::ZoneEvent[]> ring{ new CpuProfiler::ZoneEvent[RING_EVENTS] };
+    std::atomic<uint64_t> written{ 0 };
+    // Open zones; a zone deeper than MAX_DEPTH is not recorded
+    const char* openNames[MAX_DEPTH];
+    int64_t openStarts[MAX_DEPTH];
+    uint32_t depth = 0;
+};
+
+std::mutex registryMutex;  // Only taken when a thread records its first zone, and by readers
+std::vector<std::shared_ptr<ThreadBuffer>> registry;  // Kept after a thread exits, for its history
+
+std::mutex frameMutex;
+int64_t frameStarts[FRAME_MARKS];
+uint64_t frameCount = 0;
+
+ThreadBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        created->threadId = static_cast<uint32_t>(registry.size());
+        created->threadName = "Thread " + std::to_string(created->threadId);
+        registry.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+}
+
+int64_t CpuProfiler::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerStart).count();
+}
+
+void CpuProfiler::BeginZone(const char* name) {
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.depth < MAX_DEPTH) {
+        buffer.openNames[buffer.depth] = name;
+        buffer.openStarts[buffer.depth] = Now();
+    }
+    ++buffer.depth;
+}
+
+void CpuProfiler::EndZone() {
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.depth == 0)
+        return;
+    const uint32_t depth = --buffer.depth;
+    if (depth >= MAX_DEPTH)
+        return;
+
+    const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    buffer.ring[index % RING_EVENTS] = { buffer.openNames[depth], buffer.openStarts[depth], Now(), depth };
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const char* name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);  // Readers copy the name
+    buffer.threadName = name;
+}
+
+void CpuProfiler::FrameMark() {
+    int64_t now = Now();
+    std::lock_guard<std::mutex> lock(frameMutex);
+    frameStarts[frameCount % FRAME_MARKS] = now;
+    ++frameCount;
+}
+
+std::vector<int64_t> CpuProfiler::FrameStarts() {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    std::vector<int64_t> starts;
+    for (uint64_t i = frameCount > FRAME_MARKS ? frameCount - FRAME_MARKS : 0; i < frameCount; ++i)
+        starts.push_back(frameStarts[i % FRAME_MARKS]);
+    return starts;
+}
+
+std::vector<CpuProfiler::ThreadEvents> CpuProfiler::Snapshot(int64_t since) {
+    std::vector<ThreadEvents> threads;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        ThreadEvents thread{ buffer->threadId, buffer->threadName, {} };
+
+        // A thread's zones are written in the order they end, so walk back from the newest
+        const uint64_t end = buffer->written.load(std::memory_order_acquire);
+        const uint64_t begin = end > RING_EVENTS ? end - RING_EVENTS : 0;
+        for (uint64_t i = end; i > begin; --i) {
+            const ZoneEvent& e = buffer->ring[(i - 1) % RING_EVENTS];
+            if (e.end < since)
+                break;
+            thread.events.push_back(e);
+        }
+
+        // Entries the writer lapped while they were copied may be torn
+        const uint64_t after = buffer->written.load(std::memory_order_acquire);
+        const uint64_t firstValid = after > RING_EVENTS ? after - RING_EVENTS : 0;
+        if (firstValid > end - thread.events.size())
+            thread.events.resize(static_cast<size_t>(end - std::min(firstValid, end)));
+
+        std::reverse(thread.events.begin(), thread.events.end());
+        threads.push_back(std::move(thread));
+    }
+    return threads;
+}
+
+bool CpuProfiler::ExportChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open trace file for writing: " << path << std::endl;
+        return false;
+    }
+
+    size_t eventCount = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        if (!first) out << ",\n";
+        first = false;
+        return out;
+    };
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const ThreadEvents& thread : Snapshot()) {
+        separator() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread.threadId
+                    << ",\"args\":{\"name\":";
+        writeJsonString(out, thread.threadName);
+        out << "}}";
+        for (const ZoneEvent& e : thread.events) {
+            separator() << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.threadId << ",\"name\":";
+            writeJsonString(out, e.name);
+            out << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+            ++eventCount;
+        }
+    }
+    for (int64_t start : FrameStarts())
+        separator() << "{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"name\":\"Frame\",\"ts\":" << start / 1000.0 << "}";
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cerr << "Failed to write trace file: " << path << std::endl;
+        return false;
+    }
+    std::cout << "[Profiler] Wrote " << eventCount << " zones to " << path << std::endl;
+    return true;
+}
+
+#endif
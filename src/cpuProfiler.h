@@ -0,0 +1,68 @@
+#pragma once
+
+// Scoped-zone CPU profiler. PROFILE_ZONE("name") times the rest of the enclosing scope on any
+// thread; each thread writes finished zones into its own ring buffer, so recording takes no
+// locks. Built only with CPU_PROFILER defined (the ENABLE_CPU_PROFILER CMake option); otherwise
+// the macros expand to nothing and none of this is compiled.
+#if defined(CPU_PROFILER) && CPU_PROFILER
+#define CPU_PROFILER_ENABLED 1
+#else
+#define CPU_PROFILER_ENABLED 0
+#endif
+
+#if CPU_PROFILER_ENABLED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CpuProfiler {
+    struct ZoneEvent {
+        const char* name;     // Must outlive the profiler; string literals in practice
+        int64_t start, end;   // Nanoseconds since the profiler started
+        uint32_t depth;       // Zones open around this one on its thread
+    };
+    struct ThreadEvents {
+        uint32_t threadId;
+        std::string threadName;
+        std::vector<ZoneEvent> events;  // Oldest first
+    };
+
+    void BeginZone(const char* name);
+    void EndZone();
+    void SetThreadName(const char* name);
+    void FrameMark();  // Call once per frame on the main thread
+    int64_t Now();
+
+    // Every thread's zones still in its ring (those ending at or after since), and the frame marks
+    std::vector<ThreadEvents> Snapshot(int64_t since = 0);
+    std::vector<int64_t> FrameStarts();
+    // Chrome trace_event JSON (chrome://tracing, Perfetto, Speedscope)
+    bool ExportChromeTrace(const std::string& path);
+
+    struct ScopedZone {
+        explicit ScopedZone(const char* name) { BeginZone(name); }
+        ~ScopedZone() { EndZone(); }
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) CpuProfiler::ScopedZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+// For phases of straight-line code such as the main loop; every BEGIN needs its END
+#define PROFILE_BEGIN(name) CpuProfiler::BeginZone(name)
+#define PROFILE_END() CpuProfiler::EndZone()
+#define PROFILE_THREAD_NAME(name) CpuProfiler::SetThreadName(name)
+#define PROFILE_FRAME() CpuProfiler::FrameMark()
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
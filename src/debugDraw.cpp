@@ -0,0 +1,89 @@
+#include "debugDraw.h"
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <vector>
+#include "shader_utility.h"
+#include "gpuProfiler.h"
+
+namespace {
+std::vector<float> lineVertices;  // 3 pos + 3 color
+GLuint lineVAO = 0, lineVBO = 0, lineShader = 0;
+
+void InitLineBuffers() {
+    if (lineVAO != 0) return;
+
+    glGenVertexArrays(1, &lineVAO);
+    glGenBuffers(1, &lineVBO);
+    glBindVertexArray(lineVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    lineShader = createShaderProgramFromFile("debug_line.vert", "debug_line.frag");
+}
+}
+
+void DebugDraw::Line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color) {
+    lineVertices.insert(lineVertices.end(), { a.x, a.y, a.z, color.x, color.y, color.z,
+                                              b.x, b.y, b.z, color.x, color.y, color.z });
+}
+
+void DebugDraw::Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& color) {
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = center + glm::vec3((i & 1) ? halfExtents.x : -halfExtents.x,
+                                        (i & 2) ? halfExtents.y : -halfExtents.y,
+                                        (i & 4) ? halfExtents.z : -halfExtents.z);
+    }
+    // Each edge joins two corners whose indices differ by one bit
+    for (int i = 0; i < 8; ++i) {
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if (!(i & bit))
+                Line(corners[i], corners[i | bit], color);
+        }
+    }
+}
+
+void DebugDraw::HexPrism(const glm::vec3& center, float radius, float halfHeight, const glm::vec3& color) {
+    glm::vec3 ring[6];
+    for (int i = 0; i < 6; ++i) {
+        float angle = glm::radians(60.0f * i);
+        ring[i] = glm::vec3(std::cos(angle) * radius, 0.0f, std::sin(angle) * radius);
+    }
+    const glm::vec3 top = center + glm::vec3(0.0f, halfHeight, 0.0f);
+    const glm::vec3 bottom = center - glm::vec3(0.0f, halfHeight, 0.0f);
+    for (int i = 0; i < 6; ++i) {
+        const glm::vec3& a = ring[i];
+        const glm::vec3& b = ring[(i + 1) % 6];
+        Line(top + a, top + b, color);
+        Line(bottom + a, bottom + b, color);
+        Line(bottom + a, top + a, color);
+    }
+}
+
+void DebugDraw::Flush(const glm::mat4& viewProjection) {
+    if (lineVertices.empty()) return;
+
+    InitLineBuffers();
+
+    GLint currentProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+    lineShader = createShaderProgramFromFile("debug_line.vert", "debug_line.frag");  // Cached; follows hot reloads
+    glUseProgram(lineShader);
+    glUniformMatrix4fv(glGetUniformLocation(lineShader, "MVP"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glBindVertexArray(lineVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
+    glBufferData(GL_ARRAY_BUFFER, lineVertices.size() * sizeof(float), lineVertices.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lineVertices.size() / 6));
+    glBindVertexArray(0);
+    GpuProfiler::CountDraw(0);  // Lines
+    GpuProfiler::CountStateChange(4);  // Program and vertex array, set and restored
+
+    glUseProgram(currentProgram);
+    lineVertices.clear();
+}
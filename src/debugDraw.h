@@ -0,0 +1,13 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Immediate-mode line drawing for editor overlays. Lines queued during the frame are drawn
+// and cleared by Flush, after the map so they sit on top of the geometry they outline.
+namespace DebugDraw {
+    void Line(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color);
+    void Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& color);
+    // Flat-topped hex prism matching the hex voxel layout
+    void HexPrism(const glm::vec3& center, float radius, float halfHeight, const glm::vec3& color);
+
+    void Flush(const glm::mat4& viewProjection);
+}
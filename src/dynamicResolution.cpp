@@ -0,0 +1,159 @@
+#include "dynamicResolution.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+namespace {
+DynamicResolution::Settings settings;
+
+// Allocated at the full window size; lower scales render into its lower-left corner, so a
+// changing scale never reallocates anything
+GLuint sceneFBO = 0, colorBuffer = 0, depthBuffer = 0;
+int bufferW = 0, bufferH = 0;
+int sceneW = 0, sceneH = 0, windowW = 0, windowH = 0;
+bool renderingOffscreen = false;
+
+// Timestamp pairs in a ring, read a few frames later so the CPU never waits on the GPU.
+// Timestamps rather than GL_TIME_ELAPSED, which can't be nested inside other timer queries.
+constexpr int TIMER_FRAMES = 4;
+GLuint timerQueries[TIMER_FRAMES][2] = {};
+bool timerPending[TIMER_FRAMES] = {};
+int timerFrame = 0;
+float lastGpuMs = 0.0f;
+
+bool resizeBuffers(int width, int height) {
+    if (sceneFBO == 0) {
+        glGenFramebuffers(1, &sceneFBO);
+        glGenRenderbuffers(1, &colorBuffer);
+        glGenRenderbuffers(1, &depthBuffer);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Dynamic resolution framebuffer incomplete (0x" << std::hex << status << std::dec
+                  << "), rendering at full size" << std::endl;
+        return false;
+    }
+    bufferW = width;
+    bufferH = height;
+    return true;
+}
+
+// Reads every finished frame in the ring; the newest one becomes lastGpuMs
+bool collectTimers() {
+    bool updated = false;
+    for (int i = 1; i <= TIMER_FRAMES; ++i) {
+        int slot = (timerFrame + i) % TIMER_FRAMES;  // Oldest first
+        if (!timerPending[slot])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(timerQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(timerQueries[slot][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(timerQueries[slot][1], GL_QUERY_RESULT, &end);
+        timerPending[slot] = false;
+        lastGpuMs = static_cast<float>(end - start) / 1.0e6f;
+        updated = true;
+    }
+    return updated;
+}
+
+// Pixel cost goes with scale squared, so the scale that would just meet the budget is
+// scale * sqrt(target / measured). Move part of the way there each sample, and not at all
+// within a few percent of the budget, so the resolution settles instead of hunting.
+void adaptScale() {
+    if (lastGpuMs <= 0.0f)
+        return;
+    float ratio = settings.targetMs / lastGpuMs;
+    if (ratio > 0.95f && ratio < 1.05f)
+        return;
+    float ideal = settings.scale * std::sqrt(ratio);
+    settings.scale += 0.2f * (ideal - settings.scale);
+}
+}
+
+DynamicResolution::Settings& DynamicResolution::GetSettings() {
+    return settings;
+}
+
+float DynamicResolution::LastGpuMs() {
+    return lastGpuMs;
+}
+
+void DynamicResolution::BeginScene(int width, int height, int& outW, int& outH) {
+    windowW = width;
+    windowH = height;
+    settings.minScale = std::clamp(settings.minScale, 0.1f, 1.0f);
+    settings.maxScale = std::clamp(settings.maxScale, settings.minScale, 1.0f);
+    settings.scale = std::clamp(settings.scale, settings.minScale, settings.maxScale);
+
+    renderingOffscreen = settings.enabled && width > 0 && height > 0;
+    if (renderingOffscreen && (width != bufferW || height != bufferH))
+        renderingOffscreen = resizeBuffers(width, height);
+
+    if (renderingOffscreen) {
+        sceneW = std::max(1, static_cast<int>(std::lround(width * settings.scale)));
+        sceneH = std::max(1, static_cast<int>(std::lround(height * settings.scale)));
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    } else {
+        sceneW = width;
+        sceneH = height;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    glViewport(0, 0, sceneW, sceneH);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (timerQueries[0][0] == 0)
+        glGenQueries(2 * TIMER_FRAMES, &timerQueries[0][0]);
+    timerFrame = (timerFrame + 1) % TIMER_FRAMES;
+    glQueryCounter(timerQueries[timerFrame][0], GL_TIMESTAMP);
+
+    outW = sceneW;
+    outH = sceneH;
+}
+
+void DynamicResolution::EndScene() {
+    glQueryCounter(timerQueries[timerFrame][1], GL_TIMESTAMP);
+    timerPending[timerFrame] = true;
+    if (collectTimers() && settings.enabled && settings.adaptive) {
+        adaptScale();
+        settings.scale = std::clamp(settings.scale, settings.minScale, settings.maxScale);
+    }
+
+    if (renderingOffscreen) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, sceneW, sceneH, 0, 0, windowW, windowH, GL_COLOR_BUFFER_BIT,
+                          sceneW == windowW && sceneH == windowH ? GL_NEAREST : GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    glViewport(0, 0, windowW, windowH);
+}
+
+void DynamicResolution::Shutdown() {
+    if (sceneFBO != 0) {
+        glDeleteFramebuffers(1, &sceneFBO);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+    if (timerQueries[0][0] != 0)
+        glDeleteQueries(2 * TIMER_FRAMES, &timerQueries[0][0]);
+    sceneFBO = colorBuffer = depthBuffer = 0;
+    bufferW = bufferH = 0;
+    timerQueries[0][0] = 0;
+    std::fill(std::begin(timerPending), std::end(timerPending), false);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+// Renders the 3D scene into an offscreen framebuffer whose size follows the GPU time of recent
+// frames, then upscales it to the window so ImGui still draws at native resolution.
+namespace DynamicResolution {
+    struct Settings {
+        bool enabled = false;
+        bool adaptive = true;       // Off: the scale stays where the debug window puts it
+        float targetMs = 16.0f;     // GPU budget for the scene (grid, map and overlays)
+        float minScale = 0.5f;      // Per axis, of the window size
+        float maxScale = 1.0f;
+        float scale = 1.0f;         // Current scale; the adaptive mode moves it every frame
+    };
+    Settings& GetSettings();
+
+    // Binds the scene framebuffer (the window's when disabled), sets the viewport, clears and
+    // starts timing. sceneW/sceneH get the size the scene is rendered at.
+    void BeginScene(int windowW, int windowH, int& sceneW, int& sceneH);
+    // Stops timing, adapts the scale and upscales the scene into the window's framebuffer
+    void EndScene();
+
+    float LastGpuMs();  // Scene GPU time of the newest frame whose timer result came back
+    void Shutdown();    // Frees the framebuffer and timer queries
+}
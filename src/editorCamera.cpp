@@ -7,6 +7,7 @@
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include "shader_utility.h"  // For createShaderProgramFromFile
+#include "gpuProfiler.h"
 
 
 EditorCamera camera;
@@ -117,6 +118,13 @@ void EditorCamera::setTarget(const glm::vec3& target) {
     updateCameraVectors();
 }
 
+void EditorCamera::setOrbit(float newYaw, float newPitch, float newDistance) {
+    yaw = newYaw;
+    pitch = newPitch;
+    distance = newDistance;
+    updateCameraVectors();
+}
+
 glm::vec3 EditorCamera::getTarget() const {
     return target;
 }
@@ -179,11 +187,14 @@ void EditorCamera::renderGrid(const glm::mat4& mvp) {
     GLint currentProgram = 0;
     glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
 
+    setupGridShader();  // Cache lookup, so a hot-reloaded program is picked up
     glUseProgram(gridShader);
     glUniformMatrix4fv(glGetUniformLocation(gridShader, "MVP"), 1, GL_FALSE, glm::value_ptr(mvp));
     glBindVertexArray(gridVAO);
     glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(gridVertices.size() / 3));
     glBindVertexArray(0);
+    GpuProfiler::CountDraw(0);  // Lines
+    GpuProfiler::CountStateChange(4);  // Program and vertex array, set and restored
 
     glUseProgram(currentProgram);
 }
@@ -28,6 +28,7 @@ public:
     float getPitch() const { return pitch; }
 
     void setTarget(const glm::vec3& target);
+    void setOrbit(float yaw, float pitch, float distance);  // Degrees, world units from the target
     glm::vec3 getTarget() const;
 
     void renderDebugWindow();
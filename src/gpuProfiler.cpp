@@ -0,0 +1,138 @@
+#include "gpuProfiler.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+constexpr int RING = 4;  // Frames a result may take to come back before its query is reused
+
+struct Counters {
+    int drawCalls = 0;
+    int64_t triangles = 0;
+    int stateChanges = 0;
+};
+
+struct PassTimer {
+    GLuint queries[RING] = {};
+    bool pending[RING] = {};
+    std::vector<float> history;  // Circular, HISTORY entries once full
+    int historyNext = 0;
+    Counters current, last;
+};
+
+bool enabled = true;
+PassTimer timers[GpuProfiler::PASS_COUNT];
+Counters unassigned;
+int openPass = -1;
+bool queryOpen = false;
+int frameSlot = 0;
+
+Counters& currentCounters() {
+    return openPass >= 0 ? timers[openPass].current : unassigned;
+}
+
+void addSample(PassTimer& timer, float ms) {
+    if (static_cast<int>(timer.history.size()) < GpuProfiler::HISTORY) {
+        timer.history.push_back(ms);
+    } else {
+        timer.history[timer.historyNext] = ms;
+        timer.historyNext = (timer.historyNext + 1) % GpuProfiler::HISTORY;
+    }
+}
+}
+
+const char* GpuProfiler::PassName(int pass) {
+    static const char* names[PASS_COUNT] = { "Grid", "Map", "Overlays", "ImGui" };
+    return pass >= 0 && pass < PASS_COUNT ? names[pass] : "?";
+}
+
+bool& GpuProfiler::Enabled() {
+    return enabled;
+}
+
+void GpuProfiler::BeginPass(Pass pass) {
+    openPass = pass;
+    if (!enabled)
+        return;
+    PassTimer& timer = timers[pass];
+    if (timer.queries[0] == 0)
+        glGenQueries(RING, timer.queries);
+    glBeginQuery(GL_TIME_ELAPSED, timer.queries[frameSlot]);
+    queryOpen = true;
+}
+
+void GpuProfiler::EndPass(Pass pass) {
+    openPass = -1;
+    if (!queryOpen)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    queryOpen = false;
+    timers[pass].pending[frameSlot] = true;
+}
+
+void GpuProfiler::EndFrame() {
+    for (PassTimer& timer : timers) {
+        // Oldest first, so the history stays in frame order
+        for (int i = 1; i <= RING; ++i) {
+            int slot = (frameSlot + i) % RING;
+            if (!timer.pending[slot])
+                continue;
+            GLint available = 0;
+            glGetQueryObjectiv(timer.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(timer.queries[slot], GL_QUERY_RESULT, &nanoseconds);
+            timer.pending[slot] = false;
+            addSample(timer, static_cast<float>(nanoseconds) / 1.0e6f);
+        }
+        timer.last = timer.current;
+        timer.current = Counters();
+    }
+    unassigned = Counters();
+    frameSlot = (frameSlot + 1) % RING;
+}
+
+void GpuProfiler::CountDraw(int64_t triangles) {
+    Counters& counters = currentCounters();
+    ++counters.drawCalls;
+    counters.triangles += triangles;
+}
+
+void GpuProfiler::CountStateChange(int changes) {
+    currentCounters().stateChanges += changes;
+}
+
+GpuProfiler::PassStats GpuProfiler::GetPassStats(int pass) {
+    PassStats stats;
+    if (pass < 0 || pass >= PASS_COUNT)
+        return stats;
+    const PassTimer& timer = timers[pass];
+    stats.drawCalls = timer.last.drawCalls;
+    stats.triangles = timer.last.triangles;
+    stats.stateChanges = timer.last.stateChanges;
+    stats.samples = static_cast<int>(timer.history.size());
+    if (stats.samples == 0)
+        return stats;
+
+    std::vector<float> sorted = timer.history;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5f)]; };
+    float total = 0.0f;
+    for (float ms : sorted)
+        total += ms;
+    stats.averageMs = total / sorted.size();
+    stats.p50Ms = percentile(0.50f);
+    stats.p95Ms = percentile(0.95f);
+    stats.p99Ms = percentile(0.99f);
+    stats.maxMs = sorted.back();
+    return stats;
+}
+
+void GpuProfiler::Shutdown() {
+    for (PassTimer& timer : timers) {
+        if (timer.queries[0] != 0)
+            glDeleteQueries(RING, timer.queries);
+        timer = PassTimer();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// GPU time per render pass from GL_TIME_ELAPSED queries, plus draw-call, triangle and state-change
+// counts. Each pass has a ring of queries that are read back a few frames late, so measuring
+// never waits on the GPU. Passes must not nest.
+namespace GpuProfiler {
+    enum Pass { PASS_GRID, PASS_MAP, PASS_OVERLAYS, PASS_IMGUI, PASS_COUNT };
+    const char* PassName(int pass);
+
+    void BeginPass(Pass pass);
+    void EndPass(Pass pass);
+    void EndFrame();  // Collects finished queries and starts a new set of counters
+
+    // Counted against the pass that is open, or against no pass
+    void CountDraw(int64_t triangles);
+    void CountStateChange(int changes = 1);
+
+    struct PassStats {
+        float averageMs = 0.0f, p50Ms = 0.0f, p95Ms = 0.0f, p99Ms = 0.0f, maxMs = 0.0f;
+        int samples = 0;
+        // Last complete frame
+        int drawCalls = 0;
+        int64_t triangles = 0;
+        int stateChanges = 0;
+    };
+    // Over the last HISTORY frames whose results came back
+    constexpr int HISTORY = 240;
+    PassStats GetPassStats(int pass);
+
+    bool& Enabled();  // Off: no queries are issued; counters still run
+    void Shutdown();
+
+    // Times a pass for the length of a scope
+    struct ScopedPass {
+        explicit ScopedPass(Pass p) : pass(p) { BeginPass(pass); }
+        ~ScopedPass() { EndPass(pass); }
+        Pass pass;
+    };
+}
@@ -0,0 +1,123 @@
+#include "jobSystem.h"
+#include "cpuProfiler.h"
+
+#include <algorithm>
+#include <memory>
+
+JobSystem::JobSystem(unsigned threadCount) {
+    if (threadCount == AUTO_THREADS) {
+        unsigned cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void JobSystem::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        ++unfinishedJobs;
+    }
+    jobAvailable.notify_one();
+}
+
+void JobSystem::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsFinished.wait(lock, [this] { return unfinishedJobs == 0; });
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int)>& fn) {
+    if (count <= 0)
+        return;
+
+    // Shared with the helper jobs, which may only get a worker after the loop is over
+    struct Loop {
+        std::atomic<int> next{ 0 };
+        int count = 0;
+        const std::function<void(int)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable idle;
+        int running = 0;      // Helpers taking indices
+        bool closed = false;  // The caller ran out of indices; helpers starting now do nothing
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->fn = &fn;
+    auto run = [](Loop& l) {
+        for (int i = l.next++; i < l.count; i = l.next++)
+            (*l.fn)(i);
+    };
+
+    // One helper per worker pulling indices, rather than one job per index
+    int helperCount = std::min<int>(count - 1, static_cast<int>(workers.size()));
+    for (int j = 0; j < helperCount; ++j) {
+        submit([loop, run] {
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                if (loop->closed)
+                    return;
+                ++loop->running;
+            }
+            run(*loop);
+            std::lock_guard<std::mutex> lock(loop->mutex);
+            if (--loop->running == 0)
+                loop->idle.notify_one();
+        });
+    }
+
+    run(*loop);
+
+    // Only helpers already inside the loop are waited for; fn must outlive them
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->closed = true;
+    loop->idle.wait(lock, [&] { return loop->running == 0; });
+}
+
+void JobSystem::workerLoop() {
+    PROFILE_THREAD_NAME("Job Worker");
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty())
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--unfinishedJobs == 0)
+                jobsFinished.notify_all();
+        }
+    }
+}
+
+JobSystem& GetJobSystem() {
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+std::vector<unsigned> BenchmarkThreadCounts() {
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(maxThreads);
+    return counts;
+}
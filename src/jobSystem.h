@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads that run queued jobs in submission order
+class JobSystem {
+public:
+    static constexpr unsigned AUTO_THREADS = ~0u;  // One worker per core, minus the GL thread
+    // A pool with no workers is allowed; its parallelFor runs entirely on the caller
+    explicit JobSystem(unsigned threadCount = AUTO_THREADS);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void submit(std::function<void()> job);
+    void wait();  // Blocks until every submitted job has finished
+
+    // Runs fn(0..count-1) and returns once all of them are done. The calling thread takes indices
+    // as well, so the loop finishes even when every worker is busy with queued jobs (or when called
+    // from a worker); workers join in as they free up. Up to threadCount() + 1 threads take part.
+    void parallelFor(int count, const std::function<void(int)>& fn);
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsFinished;
+    int unfinishedJobs = 0;
+    bool stopping = false;
+};
+
+// Shared pool used by the editor
+JobSystem& GetJobSystem();
+
+// Thread counts a scaling benchmark steps through: 1, 2, 4, ... and then every core
+std::vector<unsigned> BenchmarkThreadCounts();
+
+
+// Unbounded multi-producer / single-consumer queue. Producers push with a single
+// CAS on the head; the consumer detaches the whole list at once and serves it in FIFO order.
+template <typename T>
+class MpscQueue {
+public:
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+    }
+
+    void push(T value) {
+        Node* node = new Node{ std::move(value), head.load(std::memory_order_relaxed) };
+        while (!head.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    // Consumer side only
+    bool pop(T& out) {
+        if (!pending) {
+            Node* list = head.exchange(nullptr, std::memory_order_acquire);
+            // Pushed newest-first; reverse to hand items out in push order
+            while (list) {
+                Node* next = list->next;
+                list->next = pending;
+                pending = list;
+                list = next;
+            }
+            if (!pending)
+                return false;
+        }
+
+        Node* node = pending;
+        pending = node->next;
+        out = std::move(node->value);
+        delete node;
+        return true;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{ nullptr };
+    Node* pending = nullptr;  // Owned by the consumer
+};
@@ -23,6 +23,12 @@
 #include "map.h"
 #include "UI.h"
 #include "mazeGen.h"
+#include "debugDraw.h"
+#include "shaderWatcher.h"
+#include "dynamicResolution.h"
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
+#include "renderBenchmark.h"
 
 
 // Window dimensions
@@ -60,8 +66,16 @@ Mesh currentMesh;
     //ImGui::End();
 //}
 
-int main()
+int main(int argc, char** argv)
 {
+    // Headless performance run instead of the editor
+    if (WantsRenderBenchmark(argc, argv)) {
+        RenderBenchmarkOptions options;
+        if (!ParseRenderBenchmarkArgs(argc, argv, options))
+            return 2;
+        return RunRenderBenchmark(options);
+    }
+
     std::filesystem::create_directories("Maps");
     // Load available shaders
     shaders = listShaderFiles(currentShaderPath);
@@ -106,6 +120,10 @@ int main()
 
     shaderProgram = createShaderProgramFromFile("basic.vert", "basic.frag");
 
+    // Recompile programs when their shader files are saved
+    StartShaderWatcher(std::filesystem::is_directory(currentShaderPath) ? currentShaderPath
+                                                                         : std::filesystem::path("bin/shaders"));
+
     // ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -119,22 +137,23 @@ int main()
     // Declare and initialize the map object
     //Map currentMap;
     
+    PROFILE_THREAD_NAME("Main");
     while (!glfwWindowShouldClose(window)) {
+    PROFILE_FRAME();
+    PROFILE_ZONE("Frame");
     float currentFrame = static_cast<float>(glfwGetTime());
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
 
+    PROFILE_BEGIN("Poll Events");
     glfwPollEvents();
+    PROFILE_END();
 
     // Start ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
-    // Clear
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
     // Matrices for grid and UI
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = camera.getViewMatrix();
@@ -143,30 +162,76 @@ int main()
     glm::mat4 mvp = projection * view * model;
 
     // ImGui UI
+    PROFILE_BEGIN("UI");
     Map& mapBuffer = UI::GetMapBuffer();
     UI::RenderMainMenuBar(mapBuffer, window);
     UI::RenderMapEditor(mapBuffer);
     UI::RenderShaderUtility(mvp);
     UI::RenderCameraDebugWindow();
+    UI::RenderGpuProfiler();
     UI::RenderMazeGenerator(mapBuffer);
     UI::RenderVoxelEditor(mapBuffer);
+#if CPU_PROFILER_ENABLED
+    UI::RenderCpuProfiler();
+#endif
+    PROFILE_END();
+
+    // The 3D scene goes to the dynamic-resolution framebuffer when that is on (cleared here)
+    int scene_w, scene_h;
+    DynamicResolution::BeginScene(display_w, display_h, scene_w, scene_h);
 
     // Grid (uses its own shader)
+    PROFILE_BEGIN("Grid");
+    GpuProfiler::BeginPass(GpuProfiler::PASS_GRID);
     camera.renderGrid(mvp);
+    GpuProfiler::EndPass(GpuProfiler::PASS_GRID);
+    PROFILE_END();
 
-    // Map object rendering
+    // Map object rendering; objects whose shaders are still compiling use the fallback program
+    UpdateShaderCompiles();
+    PROFILE_BEGIN("Map Render");
+    GpuProfiler::BeginPass(GpuProfiler::PASS_MAP);
     mapBuffer.render(camera, display_w, display_h);
+    GpuProfiler::EndPass(GpuProfiler::PASS_MAP);
+    PROFILE_END();
+
+    // Editor overlays (voxel cursor etc.)
+    PROFILE_BEGIN("Overlays");
+    GpuProfiler::BeginPass(GpuProfiler::PASS_OVERLAYS);
+    DebugDraw::Flush(projection * view);
+    GpuProfiler::EndPass(GpuProfiler::PASS_OVERLAYS);
+    PROFILE_END();
+
+    // Upscale to the window; ImGui stays at native resolution
+    DynamicResolution::EndScene();
 
     // ImGui render pass
+    PROFILE_BEGIN("ImGui Render");
     ImGui::Render();
     glfwGetFramebufferSize(window, &display_w, &display_h);
     glViewport(0, 0, display_w, display_h);
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    GpuProfiler::BeginPass(GpuProfiler::PASS_IMGUI);
+    ImDrawData* drawData = ImGui::GetDrawData();
+    ImGui_ImplOpenGL3_RenderDrawData(drawData);
+    for (int i = 0; i < drawData->CmdListsCount; ++i) {
+        const ImDrawList* list = drawData->CmdLists[i];
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+            GpuProfiler::CountDraw(cmd.ElemCount / 3);
+        GpuProfiler::CountStateChange();  // Vertex/index upload per list
+    }
+    GpuProfiler::EndPass(GpuProfiler::PASS_IMGUI);
+    GpuProfiler::EndFrame();
+    PROFILE_END();
 
+    PROFILE_BEGIN("Swap Buffers");
     glfwSwapBuffers(window);
+    PROFILE_END();
 }
 
     // Cleanup
+    StopShaderWatcher();
+    DynamicResolution::Shutdown();
+    GpuProfiler::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
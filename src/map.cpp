@@ -6,27 +6,40 @@
 #include <algorithm>
 #include <filesystem>
 #include <iomanip> // for std::quoted
+#include <cmath>
+#include <limits>
 #include "map.h"
 #include "mesh.h"
 #include "ShapeFactory.h"
 #include "shader_utility.h"
 #include "editorCamera.h"
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
+// Objects whose meshes are built at runtime and have no shape type to reload them from
+static bool isGeneratedObject(const Map::MapObject& obj) {
+    return obj.type == "VoxelChunk" || obj.type == "MazeStream";
+}
 
 // Save the map to a file in binary format
 bool Map::saveToBinaryFile(const std::string& path) const {
+    PROFILE_ZONE("Save Map (Binary)");
     std::ofstream out(path, std::ios::binary);
     if (!out) {
         std::cerr << "Failed to open file for writing: " << path << std::endl;
         return false;
     }
 
-    int32_t objectCount = static_cast<int32_t>(objects.size());
+    // Voxel chunk and streamed maze meshes are generated at runtime, so they are not stored per object
+    int32_t objectCount = static_cast<int32_t>(std::count_if(objects.begin(), objects.end(),
+        [](const MapObject& obj) { return !isGeneratedObject(obj); }));
     out.write(reinterpret_cast<char*>(&objectCount), sizeof(objectCount));
 
     for (const auto& obj : objects) {
+        if (isGeneratedObject(obj)) continue;
+
         uint32_t nameLen = static_cast<uint32_t>(obj.name.size());
         out.write(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
         out.write(obj.name.data(), nameLen);
@@ -53,6 +66,7 @@ bool Map::saveToBinaryFile(const std::string& path) const {
 
 // Load the map from a file in binary format
 bool Map::loadFromBinaryFile(const std::string& path) {
+    PROFILE_ZONE("Load Map (Binary)");
     std::ifstream in(path, std::ios::binary);
     if (!in) {
         std::cerr << "Failed to open file for reading: " << path << std::endl;
@@ -62,7 +76,7 @@ bool Map::loadFromBinaryFile(const std::string& path) {
     int32_t objectCount = 0;
     in.read(reinterpret_cast<char*>(&objectCount), sizeof(objectCount));
 
-    objects.clear();
+    clear();
     for (int i = 0; i < objectCount; ++i) {
         uint32_t nameLen = 0;
         in.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
@@ -102,6 +116,7 @@ bool Map::loadFromBinaryFile(const std::string& path) {
 
 // Saving to text file
 bool Map::saveToTextFile(const std::string& path) const {
+    PROFILE_ZONE("Save Map (Text)");
     std::ofstream out(path);
     if (!out) {
         std::cerr << "Failed to open map file for writing: " << path << std::endl;
@@ -109,6 +124,8 @@ bool Map::saveToTextFile(const std::string& path) const {
     }
 
     for (const auto& obj : objects) {
+        if (isGeneratedObject(obj)) continue;  // Rebuilt from the VoxelMap or the maze stream
+
         out << std::quoted(obj.name) << " "
             << std::quoted(obj.type) << " "
             << obj.position.x << " " << obj.position.y << " " << obj.position.z << " "
@@ -123,13 +140,14 @@ bool Map::saveToTextFile(const std::string& path) const {
 
 //Loading from text file
 bool Map::loadFromTextFile(const std::string& path) {
+    PROFILE_ZONE("Load Map (Text)");
     std::ifstream in(path);
     if (!in) {
         std::cerr << "Failed to open text map file: " << path << std::endl;
         return false;
     }
 
-    objects.clear();
+    clear();
     std::string line;
     while (std::getline(in, line)) {
         if (line.empty() || line[0] == '#') continue;
@@ -164,6 +182,10 @@ void Map::addObject(const MapObject& obj) {
     objects.push_back(copy);
 }
 
+void Map::addObjectWithMesh(const MapObject& obj) {
+    objects.push_back(obj);
+}
+
 void Map::removeObjectByName(const std::string& objectName) {
     auto it = std::remove_if(objects.begin(), objects.end(),
         [&objectName](const MapObject& obj) { return obj.name == objectName; });
@@ -178,32 +200,113 @@ void Map::removeObjectByIndex(size_t index) {
     }
 }
 
-//Clear the map buffer
+//Clear the map buffer. Voxel chunks stay: only dirty chunks are remeshed, so dropping them leaves holes
 void Map::clear() {
-    objects.clear();
+    objects.erase(std::remove_if(objects.begin(), objects.end(),
+                                 [](const MapObject& obj) { return obj.type != "VoxelChunk"; }),
+                  objects.end());
 }
 
 
 
 
 
+// Radius in pixels of the object's bounding sphere on screen; huge when the camera is inside it
+static float projectedRadius(const Mesh& mesh, const glm::mat4& model, const glm::vec3& scale,
+                             const glm::vec3& cameraPos, float pixelsPerUnit) {
+    glm::vec3 center = glm::vec3(model * glm::vec4(0.5f * (mesh.boundsMin + mesh.boundsMax), 1.0f));
+    glm::vec3 absScale = glm::abs(scale);
+    float radius = 0.5f * glm::length(mesh.boundsMax - mesh.boundsMin) * std::max({ absScale.x, absScale.y, absScale.z });
+    float distanceSq = glm::dot(center - cameraPos, center - cameraPos);
+    if (distanceSq <= radius * radius)
+        return std::numeric_limits<float>::max();
+    return pixelsPerUnit * radius / std::sqrt(distanceSq - radius * radius);
+}
+
+static glm::mat4 objectModelMatrix(const Map::MapObject& obj) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, obj.position);
+    model = glm::rotate(model, glm::radians(obj.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(obj.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(obj.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    model = glm::scale(model, obj.scale);
+    return model;
+}
+
+// Depth of every object with one minimal program and colour writes off, nearest objects first so
+// the pre-pass itself skips most hidden fragments
+void Map::renderDepthPrePass(const std::vector<glm::mat4>& models, const glm::mat4& viewProjection,
+                             const glm::vec3& cameraPos) {
+    PROFILE_ZONE("Depth Pre-Pass");
+    prePassOrder.clear();
+    for (size_t i = 0; i < objects.size(); ++i) {
+        // Bounds centre rather than the translation: voxel chunks are all placed at the origin
+        const Mesh& mesh = objects[i].mesh;
+        glm::vec3 center = glm::vec3(models[i] * glm::vec4(0.5f * (mesh.boundsMin + mesh.boundsMax), 1.0f));
+        glm::vec3 offset = center - cameraPos;
+        prePassOrder.push_back({ glm::dot(offset, offset), static_cast<uint32_t>(i) });
+    }
+    std::sort(prePassOrder.begin(), prePassOrder.end());
+
+    GLuint depthProgram = loadShader("depth_only.vert", "depth_only.frag");
+    glUseProgram(depthProgram);
+    GpuProfiler::CountStateChange(3);  // Program and colour mask on and off
+    GLint mvpLoc = glGetUniformLocation(depthProgram, "MVP");  // The fallback program has one too
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    for (const auto& entry : prePassOrder) {
+        glm::mat4 mvp = viewProjection * models[entry.second];
+        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+        objects[entry.second].mesh.render();
+    }
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
 void Map::render(const Camera& camera, int display_w, int display_h) {
-    for (const auto& obj : objects) {
-        //std::cout << "Rendering with shader pair: " << obj.vertexShader << " + " << obj.fragmentShader << "\n";
+    const float fov = glm::radians(45.0f);
+    glm::mat4 view = camera.getViewMatrix();
+    glm::mat4 projection = glm::perspective(fov, (float)display_w / (float)display_h, 0.1f, 100.0f);
+    const float pixelsPerUnit = 0.5f * display_h / std::tan(0.5f * fov);  // At unit distance
+    const glm::vec3 cameraPos = camera.getPosition();
+    lodObjectCount = 0;
+
+    modelMatrices.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        modelMatrices[i] = objectModelMatrix(objects[i]);
+
+    // With the depth buffer already final, only the nearest surface passes, so each pixel runs
+    // one object's fragment shader. LEQUAL rather than EQUAL: the object shaders compute
+    // gl_Position the same way but are not declared invariant.
+    if (depthPrePass) {
+        renderDepthPrePass(modelMatrices, projection * view, cameraPos);
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_FALSE);
+        GpuProfiler::CountStateChange(4);  // Depth func and mask, here and after the colour pass
+    }
 
+    for (size_t i = 0; i < objects.size(); ++i) {
+        MapObject& obj = objects[i];
+        const glm::mat4& model = modelMatrices[i];
+        //std::cout << "Rendering with shader pair: " << obj.vertexShader << " + " << obj.fragmentShader << "\n";
 
-        GLuint objectShaderProgram = loadShader(obj.vertexShader, obj.fragmentShader);
+        // Voxel chunk vertices are already in world space and skip the per-vertex normal matrix
+        const uint32_t features = obj.type == "VoxelChunk" ? SHADER_NO_MODEL : 0;
+        GLuint objectShaderProgram = loadShaderVariant(obj.vertexShader, obj.fragmentShader, features);
+        const ShaderLod* lod = useShaderLods ? GetShaderLod(obj.vertexShader, obj.fragmentShader, features) : nullptr;
+        if (lod) {
+            float pixels = projectedRadius(obj.mesh, model, obj.scale, cameraPos, pixelsPerUnit);
+            float threshold = lod->minPixels * lodScale;
+            if (obj.usingLod ? pixels > threshold * LOD_HYSTERESIS : pixels < threshold)
+                obj.usingLod = !obj.usingLod;
+            if (obj.usingLod) {
+                objectShaderProgram = loadShaderVariant(lod->vertexShader, lod->fragmentShader, features);
+                ++lodObjectCount;
+            }
+        } else {
+            obj.usingLod = false;
+        }
         glUseProgram(objectShaderProgram);
+        GpuProfiler::CountStateChange();
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, obj.position);
-        model = glm::rotate(model, glm::radians(obj.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(obj.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(obj.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-        model = glm::scale(model, obj.scale);
-
-        glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)display_w / (float)display_h, 0.1f, 100.0f);
         glm::mat4 mvp = projection * view * model;
 
         // Matrix uniforms
@@ -266,5 +369,10 @@ void Map::render(const Camera& camera, int display_w, int display_h) {
         // Draw
         obj.mesh.render();
     }
+
+    if (depthPrePass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
 }
 
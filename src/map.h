@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include "mesh.h"
 
@@ -18,6 +20,7 @@ public:
         std::string vertexShader;
         std::string fragmentShader;
         Mesh mesh;
+        bool usingLod = false;  // Drawn with its material's cheaper pair; kept between frames for hysteresis
 
         MapObject(const std::string& n, const std::string& t,
                   const glm::vec3& pos, const glm::vec3& rot, const glm::vec3& sc,
@@ -28,13 +31,32 @@ public:
 
     std::vector<MapObject> objects;
 
+    // Shader LOD: an object switches to its material's cheaper pair (see ShaderLod) when its
+    // projected radius falls below the material's threshold times lodScale, and back once it is
+    // LOD_HYSTERESIS times past it, so objects near the threshold don't flicker between the two
+    static constexpr float LOD_HYSTERESIS = 1.25f;
+    bool useShaderLods = true;
+    float lodScale = 1.0f;
+    int lodObjectCount = 0;  // Objects drawn with a cheaper pair in the last render
+
+    // Lays down depth for every object first, so the colour pass shades each pixel only once
+    bool depthPrePass = false;
+
     void addObject(const MapObject& obj);
+    void addObjectWithMesh(const MapObject& obj);  // Keeps obj.mesh instead of building one from the type
     void render(const Camera& camera, int display_w, int display_h);
     void removeObjectByName(const std::string& objectName);
     void removeObjectByIndex(size_t index);
-    void clear();
+    void clear();  // Keeps VoxelChunk objects, which are rebuilt from the VoxelMap
     [[nodiscard]] bool saveToBinaryFile(const std::string& filename) const;
     [[nodiscard]] bool loadFromBinaryFile(const std::string& filename);
     [[nodiscard]] bool saveToTextFile(const std::string& path) const;
     [[nodiscard]] bool loadFromTextFile(const std::string& path);
+
+private:
+    void renderDepthPrePass(const std::vector<glm::mat4>& models, const glm::mat4& viewProjection,
+                            const glm::vec3& cameraPos);
+
+    std::vector<glm::mat4> modelMatrices;                  // Per object, reused between frames
+    std::vector<std::pair<float, uint32_t>> prePassOrder;  // Squared camera distance, object index
 };
@@ -0,0 +1,289 @@
+#include "mazeAlgorithms.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// Cell indices are z * width + x; directions follow MazeGrid::hasWall
+struct CellGrid {
+    int width, depth;
+
+    bool step(uint32_t cell, int direction, uint32_t& next) const {
+        const int x = static_cast<int>(cell % width), z = static_cast<int>(cell / width);
+        switch (direction) {
+        case 0:  if (z == 0) return false;          next = cell - width; return true;
+        case 1:  if (x == width - 1) return false;  next = cell + 1;     return true;
+        case 2:  if (z == depth - 1) return false;  next = cell + width; return true;
+        default: if (x == 0) return false;          next = cell - 1;     return true;
+        }
+    }
+};
+
+void carveStep(MazeGrid& grid, uint32_t cell, int direction) {
+    grid.removeWall(static_cast<int>(cell % grid.width()), static_cast<int>(cell / grid.width()), direction);
+}
+
+struct Bits {
+    std::vector<uint64_t> words;
+    explicit Bits(size_t count) : words((count + 63) / 64, 0) {}
+    bool test(uint32_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    void set(uint32_t i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+    size_t bytes() const { return words.capacity() * sizeof(uint64_t); }
+};
+
+class BacktrackerAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Recursive Backtracker"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override { return CarveMaze(grid, rng); }
+};
+
+// Loop-erased random walks from every cell not yet in the maze; unbiased over all spanning trees
+class WilsonAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Wilson's"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override {
+        const CellGrid cells{ grid.width(), grid.depth() };
+        const uint32_t count = static_cast<uint32_t>(cells.width) * cells.depth;
+        if (count == 0)
+            return 0;
+
+        Bits inMaze(count);
+        std::vector<uint8_t> walkDirection(count);  // Last exit taken; overwriting it erases loops
+        std::uniform_int_distribution<int> directionDist(0, 3);
+        inMaze.set(std::uniform_int_distribution<uint32_t>(0, count - 1)(rng));
+
+        for (uint32_t start = 0; start < count; ++start) {
+            if (inMaze.test(start))
+                continue;
+
+            uint32_t cell = start, next = 0;
+            while (!inMaze.test(cell)) {
+                int direction;
+                do {
+                    direction = directionDist(rng);
+                } while (!cells.step(cell, direction, next));
+                walkDirection[cell] = static_cast<uint8_t>(direction);
+                cell = next;
+            }
+
+            for (cell = start; !inMaze.test(cell); cell = next) {
+                inMaze.set(cell);
+                carveStep(grid, cell, walkDirection[cell]);
+                cells.step(cell, walkDirection[cell], next);
+            }
+        }
+        return inMaze.bytes() + walkDirection.capacity();
+    }
+};
+
+// Randomly ordered walls, each removed when it joins two different union-find sets
+class KruskalAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Kruskal's"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override {
+        const int width = grid.width(), depth = grid.depth();
+        const uint32_t count = static_cast<uint32_t>(width) * depth;
+        if (count == 0)
+            return 0;
+
+        // Inner walls as (cell << 1) | axis, axis 0 = right of the cell, 1 = below it
+        std::vector<uint32_t> walls;
+        walls.reserve(2 * static_cast<size_t>(count));
+        for (uint32_t cell = 0; cell < count; ++cell) {
+            if (static_cast<int>(cell % width) < width - 1) walls.push_back(cell << 1);
+            if (static_cast<int>(cell / width) < depth - 1) walls.push_back((cell << 1) | 1);
+        }
+        std::shuffle(walls.begin(), walls.end(), rng);
+
+        std::vector<uint32_t> parent(count);
+        std::iota(parent.begin(), parent.end(), 0u);
+        auto find = [&](uint32_t cell) {
+            while (parent[cell] != cell) {
+                parent[cell] = parent[parent[cell]];  // Path halving
+                cell = parent[cell];
+            }
+            return cell;
+        };
+
+        uint32_t joined = 0;
+        for (uint32_t wall : walls) {
+            const uint32_t cell = wall >> 1;
+            const bool below = wall & 1;
+            const uint32_t a = find(cell), b = find(below ? cell + width : cell + 1);
+            if (a == b)
+                continue;
+            parent[a] = b;
+            carveStep(grid, cell, below ? 2 : 1);
+            if (++joined == count - 1)
+                break;
+        }
+        return walls.capacity() * sizeof(uint32_t) + parent.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Grows from one cell by attaching a random frontier cell to the maze each step
+class PrimAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Prim's"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override {
+        const CellGrid cells{ grid.width(), grid.depth() };
+        const uint32_t count = static_cast<uint32_t>(cells.width) * cells.depth;
+        if (count == 0)
+            return 0;
+
+        enum : uint8_t { OUTSIDE, FRONTIER, INSIDE };
+        std::vector<uint8_t> state(count, OUTSIDE);
+        std::vector<uint32_t> frontier;
+        auto addCell = [&](uint32_t cell) {
+            state[cell] = INSIDE;
+            uint32_t next;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (cells.step(cell, direction, next) && state[next] == OUTSIDE) {
+                    state[next] = FRONTIER;
+                    frontier.push_back(next);
+                }
+            }
+        };
+        addCell(std::uniform_int_distribution<uint32_t>(0, count - 1)(rng));
+
+        while (!frontier.empty()) {
+            const size_t pick = std::uniform_int_distribution<size_t>(0, frontier.size() - 1)(rng);
+            const uint32_t cell = frontier[pick];
+            frontier[pick] = frontier.back();
+            frontier.pop_back();
+
+            int options[4], optionCount = 0;
+            uint32_t next;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (cells.step(cell, direction, next) && state[next] == INSIDE)
+                    options[optionCount++] = direction;
+            }
+            carveStep(grid, cell, options[std::uniform_int_distribution<int>(0, optionCount - 1)(rng)]);
+            addCell(cell);
+        }
+        return state.capacity() + frontier.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Backtracker/Prim hybrid: extends the newest active cell half of the time and a random one
+// otherwise, which gives long corridors with more branching than the pure backtracker
+class GrowingTreeAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Growing Tree"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override {
+        const CellGrid cells{ grid.width(), grid.depth() };
+        const uint32_t count = static_cast<uint32_t>(cells.width) * cells.depth;
+        if (count == 0)
+            return 0;
+
+        Bits visited(count);
+        std::vector<uint32_t> active;
+        std::bernoulli_distribution takeNewest(0.5);
+        const uint32_t start = std::uniform_int_distribution<uint32_t>(0, count - 1)(rng);
+        visited.set(start);
+        active.push_back(start);
+
+        while (!active.empty()) {
+            const size_t pick = takeNewest(rng) ? active.size() - 1
+                                                : std::uniform_int_distribution<size_t>(0, active.size() - 1)(rng);
+            const uint32_t cell = active[pick];
+
+            int options[4], optionCount = 0;
+            uint32_t next;
+            for (int direction = 0; direction < 4; ++direction) {
+                if (cells.step(cell, direction, next) && !visited.test(next))
+                    options[optionCount++] = direction;
+            }
+            if (optionCount == 0) {
+                active[pick] = active.back();  // Order only matters for the newest cell
+                active.pop_back();
+                continue;
+            }
+
+            const int direction = options[std::uniform_int_distribution<int>(0, optionCount - 1)(rng)];
+            cells.step(cell, direction, next);
+            carveStep(grid, cell, direction);
+            visited.set(next);
+            active.push_back(next);
+        }
+        return visited.bytes() + active.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Every cell opens up or right; no working memory, but a strong diagonal bias and two open borders
+class BinaryTreeAlgorithm : public MazeAlgorithm {
+public:
+    const char* name() const override { return "Binary Tree"; }
+    size_t carve(MazeGrid& grid, std::mt19937& rng) const override {
+        std::bernoulli_distribution goUp(0.5);
+        for (int z = 0; z < grid.depth(); ++z) {
+            for (int x = 0; x < grid.width(); ++x) {
+                const bool canUp = z > 0, canRight = x < grid.width() - 1;
+                if (canUp && (!canRight || goUp(rng)))
+                    grid.removeWall(x, z, 0);
+                else if (canRight)
+                    grid.removeWall(x, z, 1);
+            }
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+const std::vector<const MazeAlgorithm*>& MazeAlgorithms() {
+    static const BacktrackerAlgorithm backtracker;
+    static const WilsonAlgorithm wilson;
+    static const KruskalAlgorithm kruskal;
+    static const PrimAlgorithm prim;
+    static const GrowingTreeAlgorithm growingTree;
+    static const BinaryTreeAlgorithm binaryTree;
+    static const std::vector<const MazeAlgorithm*> algorithms = {
+        &backtracker, &wilson, &kruskal, &prim, &growingTree, &binaryTree
+    };
+    return algorithms;
+}
+
+MazeStats ComputeMazeStats(const MazeGrid& grid) {
+    MazeStats stats;
+    for (int z = 0; z < grid.depth(); ++z) {
+        for (int x = 0; x < grid.width(); ++x) {
+            int open = 0;
+            for (int direction = 0; direction < 4; ++direction)
+                open += !grid.hasWall(x, z, direction);
+            ++stats.cells;
+            if (open == 1) ++stats.deadEnds;
+            else if (open == 2) ++stats.corridors;
+            else if (open >= 3) ++stats.junctions;
+        }
+    }
+    return stats;
+}
+
+void BenchmarkMazeAlgorithms() {
+    const int size = 1000;
+    const uint32_t seed = 12345;
+    std::cout << "[Maze] Algorithm benchmark, " << size << "x" << size << " (seed " << seed << ")" << std::endl;
+
+    for (const MazeAlgorithm* algorithm : MazeAlgorithms()) {
+        MazeGrid grid;
+        grid.reset(size, size);
+        std::mt19937 rng(seed);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t workingBytes = algorithm->carve(grid, rng);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        MazeStats stats = ComputeMazeStats(grid);
+        auto percent = [&](size_t n) { return 100.0 * n / std::max<size_t>(stats.cells, 1); };
+        std::cout << "  " << algorithm->name() << ": "
+                  << static_cast<long long>(stats.cells / std::max(seconds, 1e-9)) << " cells/s, "
+                  << seconds * 1000.0 << " ms, memory " << grid.memoryBytes() / 1024 << " KB grid + "
+                  << workingBytes / 1024 << " KB working, dead ends " << percent(stats.deadEnds)
+                  << "%, corridors " << percent(stats.corridors) << "%, junctions " << percent(stats.junctions)
+                  << "%" << std::endl;
+    }
+}
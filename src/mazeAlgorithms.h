@@ -0,0 +1,34 @@
+// mazeAlgorithms.h
+#ifndef MAZE_ALGORITHMS_H
+#define MAZE_ALGORITHMS_H
+
+#include "mazeGen.h"
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// A way of carving a perfect maze into a MazeGrid that starts with every wall up
+class MazeAlgorithm {
+public:
+    virtual ~MazeAlgorithm() = default;
+    virtual const char* name() const = 0;
+    // Returns the bytes of working memory the algorithm needed on top of the grid
+    virtual size_t carve(MazeGrid& grid, std::mt19937& rng) const = 0;
+};
+
+// Recursive backtracker (CarveMaze), Wilson's, Kruskal's, Prim's, growing tree and binary tree
+const std::vector<const MazeAlgorithm*>& MazeAlgorithms();
+
+// Layout statistics of a carved maze
+struct MazeStats {
+    size_t cells = 0;
+    size_t deadEnds = 0;   // One open side
+    size_t corridors = 0;  // Two open sides
+    size_t junctions = 0;  // Three or four open sides
+};
+MazeStats ComputeMazeStats(const MazeGrid& grid);
+
+// Runs every algorithm on the same size and prints cells/second, memory use and layout stats
+void BenchmarkMazeAlgorithms();
+
+#endif
@@ -1,130 +1,275 @@
 #include "mazeGen.h"
+#include "mazeAlgorithms.h"
+#include "mazeStream.h"
 #include "map.h"
 #include "ShapeFactory.h"
+#include "cpuProfiler.h"
 
 #include <glm/glm.hpp>
 #include <vector>
 #include <random>
 #include <algorithm>
 #include <iostream>
+#include <chrono>
+#include <cmath>
 
-static void carveMaze(int x, int z, int width, int depth,
-                      std::vector<std::vector<bool>>& visited,
-                      std::vector<std::vector<bool>>& verticalWalls,
-                      std::vector<std::vector<bool>>& horizontalWalls) {
-    visited[z][x] = true;
+void MazeGrid::reset(int width, int depth) {
+    w = width;
+    d = depth;
+    vertical.assign((static_cast<size_t>(width + 1) * depth + 63) / 64, ~uint64_t(0));
+    horizontal.assign((static_cast<size_t>(width) * (depth + 1) + 63) / 64, ~uint64_t(0));
+}
 
-    std::vector<std::pair<int, int>> directions = {
-        {0, -1}, {1, 0}, {0, 1}, {-1, 0}  // Up, Right, Down, Left
-    };
+size_t CarveMaze(MazeGrid& grid, std::mt19937& rng) {
+    const int width = grid.width();
+    const int depth = grid.depth();
+    if (width <= 0 || depth <= 0)
+        return 0;
 
-    std::shuffle(directions.begin(), directions.end(), std::mt19937{ std::random_device{}() });
+    // Visited cells as bits; the explicit stack holds the current path as cell indices
+    std::vector<uint64_t> visited((static_cast<size_t>(width) * depth + 63) / 64, 0);
+    auto markVisited = [&](uint32_t cell) { visited[cell >> 6] |= uint64_t(1) << (cell & 63); };
+    auto isVisited = [&](uint32_t cell) { return (visited[cell >> 6] >> (cell & 63)) & 1; };
 
-    for (auto [dx, dz] : directions) {
-        int nx = x + dx;
-        int nz = z + dz;
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    markVisited(0);
 
-        if (nx >= 0 && nx < width && nz >= 0 && nz < depth && !visited[nz][nx]) {
-            if (dx == 1)       verticalWalls[z][x + 1] = false; // remove right wall
-            else if (dx == -1) verticalWalls[z][x] = false;     // remove left wall
-            else if (dz == 1)  horizontalWalls[z + 1][x] = false; // remove bottom wall
-            else if (dz == -1) horizontalWalls[z][x] = false;     // remove top wall
+    while (!stack.empty()) {
+        const uint32_t cell = stack.back();
+        const int x = static_cast<int>(cell % width);
+        const int z = static_cast<int>(cell / width);
 
-            carveMaze(nx, nz, width, depth, visited, verticalWalls, horizontalWalls);
+        // Unvisited neighbours: 0 up, 1 right, 2 down, 3 left
+        int options[4];
+        int count = 0;
+        if (z > 0 && !isVisited(cell - width))         options[count++] = 0;
+        if (x < width - 1 && !isVisited(cell + 1))     options[count++] = 1;
+        if (z < depth - 1 && !isVisited(cell + width)) options[count++] = 2;
+        if (x > 0 && !isVisited(cell - 1))             options[count++] = 3;
 
+        if (count == 0) {
+            stack.pop_back();  // Dead end, backtrack
+            continue;
+        }
 
+        uint32_t next = cell;
+        switch (options[count == 1 ? 0 : std::uniform_int_distribution<int>(0, count - 1)(rng)]) {
+        case 0: grid.setHorizontalWall(x, z, false);     next = cell - width; break;  // remove top wall
+        case 1: grid.setVerticalWall(x + 1, z, false);   next = cell + 1;     break;  // remove right wall
+        case 2: grid.setHorizontalWall(x, z + 1, false); next = cell + width; break;  // remove bottom wall
+        case 3: grid.setVerticalWall(x, z, false);       next = cell - 1;     break;  // remove left wall
         }
+        markVisited(next);
+        stack.push_back(next);
     }
+    return visited.capacity() * sizeof(uint64_t) + stack.capacity() * sizeof(uint32_t);
 }
 
+void AddRandomOpenSpaces(MazeGrid& grid, std::mt19937& rng) {
+    const int width = grid.width();
+    const int depth = grid.depth();
+    if (width <= 0 || depth <= 0)
+        return;
 
+    int extraRemovals = (width * depth) / 5;
+    std::uniform_int_distribution<int> xDist(0, width - 1);
+    std::uniform_int_distribution<int> zDist(0, depth - 1);
+    std::uniform_int_distribution<int> dirDist(0, 3); // up, right, down, left
 
+    for (int i = 0; i < extraRemovals; ++i) {
+        int x = xDist(rng);
+        int z = zDist(rng);
+        int dir = dirDist(rng);
 
-void GenerateMaze(Map& mapBuffer, int width, int depth, float cellSize,
-                  float floorHeight, const std::string& shaderBase,
-                  bool randomOpenSpaces) {
-    mapBuffer.clear();
+        if (dir == 0 && z > 0) {
+            grid.setHorizontalWall(x, z, false); // top
+        } else if (dir == 1 && x < width - 1) {
+            grid.setVerticalWall(x + 1, z, false); // right
+        } else if (dir == 2 && z < depth - 1) {
+            grid.setHorizontalWall(x, z + 1, false); // bottom
+        } else if (dir == 3 && x > 0) {
+            grid.setVerticalWall(x, z, false); // left
+        }
+    }
+}
+
+std::vector<MazeBox> BuildMazeBoxes(const MazeGrid& grid, float cellSize, float floorHeight, bool merge,
+                                    const std::vector<uint8_t>* floorCells) {
+    PROFILE_ZONE("Build Maze Boxes");
+    const int width = grid.width();
+    const int depth = grid.depth();
+    const float cs = cellSize;
+    const float offsetX = -(width * cs) / 2.0f + cs / 2.0f;
+    const float offsetZ = -(depth * cs) / 2.0f + cs / 2.0f;
+    const float wallY = floorHeight + 0.5f;
+    std::vector<MazeBox> boxes;
 
-    std::vector<std::vector<bool>> visited(depth, std::vector<bool>(width, false));
-    std::vector<std::vector<bool>> horizontalWalls(depth + 1, std::vector<bool>(width, true));
-    std::vector<std::vector<bool>> verticalWalls(depth, std::vector<bool>(width + 1, true));
-
-    carveMaze(0, 0, width, depth, visited, verticalWalls, horizontalWalls);
-
-    if (randomOpenSpaces) {
-        int extraRemovals = (width * depth) / 5;
-
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_int_distribution<int> xDist(0, width - 1);
-        std::uniform_int_distribution<int> zDist(0, depth - 1);
-        std::uniform_int_distribution<int> dirDist(0, 3); // up, right, down, left
-
-        for (int i = 0; i < extraRemovals; ++i) {
-            int x = xDist(rng);
-            int z = zDist(rng);
-            int dir = dirDist(rng);
-
-            if (dir == 0 && z > 0) {
-                horizontalWalls[z][x] = false; // top
-            } else if (dir == 1 && x < width - 1) {
-                verticalWalls[z][x + 1] = false; // right
-            } else if (dir == 2 && z < depth - 1) {
-                horizontalWalls[z + 1][x] = false; // bottom
-            } else if (dir == 3 && x > 0) {
-                verticalWalls[z][x] = false; // left
+    // Cell a..b-1 along one axis -> centre of the span
+    auto spanCenter = [&](float offset, int a, int b) { return offset + (a + b - 1) * 0.5f * cs; };
+
+    if (!merge) {
+        // One box per floor cell and per wall segment
+        for (int z = 0; z < depth; ++z) {
+            for (int x = 0; x < width; ++x) {
+                glm::vec3 basePos(x * cs + offsetX, floorHeight, z * cs + offsetZ);
+                if (!floorCells || (*floorCells)[static_cast<size_t>(z) * width + x])
+                    boxes.push_back({ "floor", "Floor", basePos, glm::vec3(cs, 0.1f, cs) });
+                if (grid.verticalWall(x + 1, z))
+                    boxes.push_back({ "depthWall", "DepthWall", glm::vec3(basePos.x + cs / 2.0f, wallY, basePos.z), glm::vec3(0.1f, 1.0f, cs) });
+                if (grid.horizontalWall(x, z + 1))
+                    boxes.push_back({ "widthWall", "WidthWall", glm::vec3(basePos.x, wallY, basePos.z + cs / 2.0f), glm::vec3(cs, 1.0f, 0.1f) });
+                if (z == 0 && grid.horizontalWall(x, z))
+                    boxes.push_back({ "topWall", "WidthWall", glm::vec3(basePos.x, wallY, basePos.z - cs / 2.0f), glm::vec3(cs, 1.0f, 0.1f) });
+                if (x == 0 && grid.verticalWall(x, z))
+                    boxes.push_back({ "leftWall", "DepthWall", glm::vec3(basePos.x - cs / 2.0f, wallY, basePos.z), glm::vec3(0.1f, 1.0f, cs) });
             }
         }
+        return boxes;
     }
 
-    float offsetX = -(width * cellSize) / 2.0f + cellSize / 2.0f;
-    float offsetZ = -(depth * cellSize) / 2.0f + cellSize / 2.0f;
-
+    // Floor: greedy maximal rectangles over the cells that have a floor
+    std::vector<uint8_t> floorLeft = floorCells ? *floorCells : std::vector<uint8_t>(static_cast<size_t>(width) * depth, 1);
+    auto row = [&](int z) { return floorLeft.data() + static_cast<size_t>(z) * width; };
     for (int z = 0; z < depth; ++z) {
         for (int x = 0; x < width; ++x) {
-            glm::vec3 basePos = glm::vec3(x * cellSize + offsetX, floorHeight, z * cellSize + offsetZ);
-
-            Map::MapObject floorObj("floor", "Floor", basePos, glm::vec3(0.0f),
-                glm::vec3(1.0f, 0.1f, 1.0f), shaderBase + ".vert", shaderBase + ".frag");
-            floorObj.mesh = generateMeshForType("Cube", 1.0f);
-            mapBuffer.addObject(floorObj);
-
-            if (verticalWalls[z][x + 1]) {
-                glm::vec3 wallPos = basePos + glm::vec3(cellSize / 2.0f, 0.5f, 0.0f);
-                wallPos.y = floorHeight + 0.5f;
-                Map::MapObject wall("depthWall", "DepthWall", wallPos, glm::vec3(0.0f),
-                    glm::vec3(0.1f, 1.0f, 1.0f), shaderBase + ".vert", shaderBase + ".frag");
-                wall.mesh = generateMeshForType("Cube", 1.0f);
-                mapBuffer.addObject(wall);
-            }
-
-            if (horizontalWalls[z + 1][x]) {
-                glm::vec3 wallPos = basePos + glm::vec3(0.0f, 0.5f, cellSize / 2.0f);
-                wallPos.y = floorHeight + 0.5f;
-                Map::MapObject wall("widthWall", "WidthWall", wallPos, glm::vec3(0.0f),
-                    glm::vec3(1.0f, 1.0f, 0.1f), shaderBase + ".vert", shaderBase + ".frag");
-                wall.mesh = generateMeshForType("Cube", 1.0f);
-                mapBuffer.addObject(wall);
-            }
+            if (!row(z)[x])
+                continue;
+            int x1 = x;
+            while (x1 < width && row(z)[x1])
+                ++x1;
+            int z1 = z + 1;
+            while (z1 < depth && std::all_of(row(z1) + x, row(z1) + x1, [](uint8_t left) { return left != 0; }))
+                ++z1;
+            for (int fz = z; fz < z1; ++fz)
+                std::fill(row(fz) + x, row(fz) + x1, 0);
+            boxes.push_back({ "floor", "Floor", glm::vec3(spanCenter(offsetX, x, x1), floorHeight, spanCenter(offsetZ, z, z1)),
+                              glm::vec3((x1 - x) * cs, 0.1f, (z1 - z) * cs) });
+        }
+    }
 
-            if (z == 0 && horizontalWalls[z][x]) {
-                glm::vec3 wallPos = basePos + glm::vec3(0.0f, 0.5f, -cellSize / 2.0f);
-                wallPos.y = floorHeight + 0.5f;
-                Map::MapObject wall("topWall", "WidthWall", wallPos, glm::vec3(0.0f),
-                    glm::vec3(1.0f, 1.0f, 0.1f), shaderBase + ".vert", shaderBase + ".frag");
-                wall.mesh = generateMeshForType("Cube", 1.0f);
-                mapBuffer.addObject(wall);
+    // Walls: runs of consecutive segments along each grid line
+    for (int line = 0; line <= depth; ++line) {
+        const float lineZ = offsetZ + (line - 0.5f) * cs;
+        for (int x = 0; x < width;) {
+            if (!grid.horizontalWall(x, line)) {
+                ++x;
+                continue;
             }
-
-            if (x == 0 && verticalWalls[z][x]) {
-                glm::vec3 wallPos = basePos + glm::vec3(-cellSize / 2.0f, 0.5f, 0.0f);
-                wallPos.y = floorHeight + 0.5f;
-                Map::MapObject wall("leftWall", "DepthWall", wallPos, glm::vec3(0.0f),
-                    glm::vec3(0.1f, 1.0f, 1.0f), shaderBase + ".vert", shaderBase + ".frag");
-                wall.mesh = generateMeshForType("Cube", 1.0f);
-                mapBuffer.addObject(wall);
+            int end = x;
+            while (end < width && grid.horizontalWall(end, line))
+                ++end;
+            boxes.push_back({ "widthWall", "WidthWall", glm::vec3(spanCenter(offsetX, x, end), wallY, lineZ),
+                              glm::vec3((end - x) * cs, 1.0f, 0.1f) });
+            x = end;
+        }
+    }
+    for (int line = 0; line <= width; ++line) {
+        const float lineX = offsetX + (line - 0.5f) * cs;
+        for (int z = 0; z < depth;) {
+            if (!grid.verticalWall(line, z)) {
+                ++z;
+                continue;
             }
+            int end = z;
+            while (end < depth && grid.verticalWall(line, end))
+                ++end;
+            boxes.push_back({ "depthWall", "DepthWall", glm::vec3(lineX, wallY, spanCenter(offsetZ, z, end)),
+                              glm::vec3(0.1f, 1.0f, (end - z) * cs) });
+            z = end;
         }
     }
+    return boxes;
+}
+
+MazeGrid CarveMazeGrid(int width, int depth, bool randomOpenSpaces, uint32_t seed, int algorithm) {
+    PROFILE_ZONE("Carve Maze");
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    algorithm = std::clamp(algorithm, 0, static_cast<int>(algorithms.size()) - 1);
+
+    std::mt19937 rng(seed);
+    MazeGrid grid;
+    grid.reset(width, depth);
+    algorithms[algorithm]->carve(grid, rng);
+
+    if (randomOpenSpaces)
+        AddRandomOpenSpaces(grid, rng);
+    return grid;
+}
+
+void GenerateMaze(Map& mapBuffer, int width, int depth, float cellSize,
+                  float floorHeight, const std::string& shaderBase,
+                  bool randomOpenSpaces, uint32_t seed, int algorithm) {
+    PROFILE_ZONE("Generate Maze");
+    StopMazeStream(mapBuffer);  // Its chunks go with the clear
+    mapBuffer.clear();
+
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    algorithm = std::clamp(algorithm, 0, static_cast<int>(algorithms.size()) - 1);
+    MazeGrid grid = CarveMazeGrid(width, depth, randomOpenSpaces, seed, algorithm);
+
+    for (const MazeBox& box : BuildMazeBoxes(grid, cellSize, floorHeight, true)) {
+        mapBuffer.addObject(Map::MapObject(box.name, box.type, box.position, glm::vec3(0.0f), box.scale,
+                                           shaderBase + ".vert", shaderBase + ".frag"));
+    }
+
+    std::cout << "Maze generated: " << width << " x " << depth << " with " << algorithms[algorithm]->name()
+              << " (seed " << seed << ")" << std::endl;
+}
+
+void BenchmarkMazeGeneration() {
+    const uint32_t seed = 12345;
+    std::cout << "[Maze] Generation benchmark (seed " << seed << ")" << std::endl;
+
+    for (int size : { 1000, 4000 }) {
+        MazeGrid grid;
+        auto start = std::chrono::steady_clock::now();
+        grid.reset(size, size);
+        std::mt19937 rng(seed);
+        CarveMaze(grid, rng);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Same seed, same maze
+        MazeGrid again;
+        again.reset(size, size);
+        std::mt19937 rngAgain(seed);
+        CarveMaze(again, rngAgain);
+
+        // A perfect maze over N cells has exactly N - 1 open inner walls
+        size_t open = 0;
+        for (int z = 0; z < size; ++z)
+            for (int x = 1; x < size; ++x)
+                open += !grid.verticalWall(x, z);
+        for (int z = 1; z < size; ++z)
+            for (int x = 0; x < size; ++x)
+                open += !grid.horizontalWall(x, z);
+
+        std::cout << "  " << size << "x" << size << ": " << ms << " ms ("
+                  << static_cast<long long>(static_cast<double>(size) * size / (ms / 1000.0)) << " cells/s), "
+                  << "repeat seed " << (grid == again ? "matches" : "DIFFERS") << ", "
+                  << (open == static_cast<size_t>(size) * size - 1 ? "perfect maze" : "NOT a perfect maze")
+                  << std::endl;
+    }
+}
+
+void BenchmarkMazeMerging() {
+    const int size = 200;
+    const float cellSize = 1.0f;
+    std::cout << "[Maze] Wall/floor merging, " << size << "x" << size << std::endl;
+
+    for (const MazeAlgorithm* algorithm : MazeAlgorithms()) {
+        MazeGrid grid;
+        grid.reset(size, size);
+        std::mt19937 rng(12345);
+        algorithm->carve(grid, rng);
 
-    std::cout << "Maze generated: " << width << " x " << depth << std::endl;
+        std::vector<MazeBox> perCell = BuildMazeBoxes(grid, cellSize, 0.0f, false);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<MazeBox> merged = BuildMazeBoxes(grid, cellSize, 0.0f, true);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "  " << algorithm->name() << ": " << perCell.size() << " objects -> " << merged.size()
+                  << " (" << static_cast<double>(perCell.size()) / std::max<size_t>(merged.size(), 1) << "x fewer) in "
+                  << ms << " ms" << std::endl;
+    }
 }
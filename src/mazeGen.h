@@ -3,11 +3,95 @@
 #define MAZE_GEN_H
 
 #include "map.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Wall layout of a width x depth maze, one bit per wall.
+// Vertical walls run along z and sit at x = 0..width; horizontal walls run along x at z = 0..depth.
+class MazeGrid {
+public:
+    void reset(int width, int depth);  // Every wall up
+
+    int width() const { return w; }
+    int depth() const { return d; }
+
+    bool verticalWall(int x, int z) const { return test(vertical, static_cast<size_t>(z) * (w + 1) + x); }
+    bool horizontalWall(int x, int z) const { return test(horizontal, static_cast<size_t>(z) * w + x); }
+    void setVerticalWall(int x, int z, bool wall) { assign(vertical, static_cast<size_t>(z) * (w + 1) + x, wall); }
+    void setHorizontalWall(int x, int z, bool wall) { assign(horizontal, static_cast<size_t>(z) * w + x, wall); }
+
+    // Walls around a cell by direction: 0 up (-z), 1 right (+x), 2 down (+z), 3 left (-x)
+    bool hasWall(int x, int z, int direction) const {
+        switch (direction) {
+        case 0:  return horizontalWall(x, z);
+        case 1:  return verticalWall(x + 1, z);
+        case 2:  return horizontalWall(x, z + 1);
+        default: return verticalWall(x, z);
+        }
+    }
+    void removeWall(int x, int z, int direction) {
+        switch (direction) {
+        case 0:  setHorizontalWall(x, z, false); break;
+        case 1:  setVerticalWall(x + 1, z, false); break;
+        case 2:  setHorizontalWall(x, z + 1, false); break;
+        default: setVerticalWall(x, z, false); break;
+        }
+    }
+    size_t memoryBytes() const { return (vertical.size() + horizontal.size()) * sizeof(uint64_t); }
+
+    bool operator==(const MazeGrid& other) const {
+        return w == other.w && d == other.d && vertical == other.vertical && horizontal == other.horizontal;
+    }
+
+private:
+    int w = 0, d = 0;
+    std::vector<uint64_t> vertical;
+    std::vector<uint64_t> horizontal;
+
+    static bool test(const std::vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+    static void assign(std::vector<uint64_t>& bits, size_t i, bool value) {
+        if (value) bits[i >> 6] |= uint64_t(1) << (i & 63);
+        else       bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    }
+};
+
+// Carves a perfect maze with an iterative depth-first search starting at cell (0, 0).
+// The same seed always gives the same maze. Returns the bytes of working memory used.
+size_t CarveMaze(MazeGrid& grid, std::mt19937& rng);
+// Knocks down about one extra wall per five cells, turning the maze into one with loops
+void AddRandomOpenSpaces(MazeGrid& grid, std::mt19937& rng);
+
+// One axis-aligned box of maze geometry, in MapObject terms
+struct MazeBox {
+    std::string name;
+    std::string type;  // Floor, WidthWall (runs along x) or DepthWall (runs along z)
+    glm::vec3 position;
+    glm::vec3 scale;
+};
+
+// Floor and wall boxes for a carved grid, centred on the origin. With merge, consecutive wall
+// segments on a grid line become one wall and floor cells are joined into maximal rectangles;
+// without it there is one box per cell and per wall segment. floorCells (width * depth, x fastest)
+// leaves out the floor where it is 0, e.g. above a stairwell; null means a floor everywhere.
+std::vector<MazeBox> BuildMazeBoxes(const MazeGrid& grid, float cellSize, float floorHeight, bool merge,
+                                    const std::vector<uint8_t>* floorCells = nullptr);
+
+// The grid GenerateMaze builds for these settings, without touching a map
+MazeGrid CarveMazeGrid(int width, int depth, bool randomOpenSpaces, uint32_t seed, int algorithm = 0);
 
 // Generates a maze and fills the provided map buffer.
-// You can pass shader name and cell size.
+// You can pass shader name and cell size; algorithm indexes MazeAlgorithms() (mazeAlgorithms.h).
 void GenerateMaze(Map& mapBuffer, int width, int depth, float cellSize,
                   float floorHeight, const std::string& shaderBase,
-                  bool randomOpenSpaces);
+                  bool randomOpenSpaces, uint32_t seed, int algorithm = 0);
+
+// Builds merged and per-cell geometry for each algorithm and prints the object counts and the
+// merge time. tests/editorTests.cpp checks that both cover the same cells and wall segments.
+void BenchmarkMazeMerging();
+
+// Times maze carving at 1000x1000 and 4000x4000, checks that a repeated seed reproduces the
+// maze and prints the results
+void BenchmarkMazeGeneration();
 
 #endif
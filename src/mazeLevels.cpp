@@ -0,0 +1,188 @@
+#include "mazeLevels.h"
+#include "mazeAlgorithms.h"
+#include "mazeStream.h"
+#include "cpuProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// Walls are 1 unit tall on a 0.1 floor, so levels closer than this would overlap
+const float MIN_LEVEL_HEIGHT = 1.1f;
+const int STAIR_STEPS = 4;
+
+std::mt19937 levelRng(uint32_t seed, int level) {
+    std::seed_seq seq{ seed, static_cast<uint32_t>(level) };
+    return std::mt19937(seq);
+}
+
+// Cell of every stairwell, drawn from its own stream so it does not depend on the carving.
+// A level's stairs never stand under the hole the stairs from the level below come up through.
+std::vector<MazeLevels::Stairwell> pickStairwells(int width, int depth, int levelCount, uint32_t seed) {
+    std::vector<MazeLevels::Stairwell> stairwells;
+    std::mt19937 rng = levelRng(seed, -1);
+    std::uniform_int_distribution<int> xDist(0, width - 1), zDist(0, depth - 1);
+    for (int level = 0; level + 1 < levelCount; ++level) {
+        MazeLevels::Stairwell stairwell{ level, xDist(rng), zDist(rng) };
+        if (level > 0 && width * depth > 1) {
+            const MazeLevels::Stairwell& below = stairwells.back();
+            while (stairwell.x == below.x && stairwell.z == below.z) {
+                stairwell.x = xDist(rng);
+                stairwell.z = zDist(rng);
+            }
+        }
+        stairwells.push_back(stairwell);
+    }
+    return stairwells;
+}
+
+void carveLevel(MazeGrid& grid, int width, int depth, int level, bool randomOpenSpaces, uint32_t seed,
+                const MazeAlgorithm& algorithm) {
+    std::mt19937 rng = levelRng(seed, level);
+    grid.reset(width, depth);
+    algorithm.carve(grid, rng);
+    if (randomOpenSpaces)
+        AddRandomOpenSpaces(grid, rng);
+}
+
+// Every cell of every level reachable from cell (0, 0) of level 0
+bool stackConnected(const MazeLevels& maze) {
+    if (maze.levels.empty())
+        return true;
+    const int width = maze.levels[0].width(), depth = maze.levels[0].depth();
+    const size_t levelCells = static_cast<size_t>(width) * depth;
+    std::vector<uint8_t> seen(levelCells * maze.levels.size(), 0);
+    std::vector<size_t> stack{ 0 };
+    seen[0] = 1;
+    size_t reached = 1;
+
+    auto visit = [&](size_t cell) {
+        if (!seen[cell]) {
+            seen[cell] = 1;
+            ++reached;
+            stack.push_back(cell);
+        }
+    };
+
+    while (!stack.empty()) {
+        const size_t cell = stack.back();
+        stack.pop_back();
+        const int level = static_cast<int>(cell / levelCells);
+        const int x = static_cast<int>(cell % levelCells % width), z = static_cast<int>(cell % levelCells / width);
+        const MazeGrid& grid = maze.levels[level];
+        if (!grid.hasWall(x, z, 0)) visit(cell - width);
+        if (!grid.hasWall(x, z, 1)) visit(cell + 1);
+        if (!grid.hasWall(x, z, 2)) visit(cell + width);
+        if (!grid.hasWall(x, z, 3)) visit(cell - 1);
+        for (const MazeLevels::Stairwell& stairwell : maze.stairwells) {
+            if (stairwell.x != x || stairwell.z != z)
+                continue;
+            if (stairwell.level == level) visit(cell + levelCells);
+            if (stairwell.level + 1 == level) visit(cell - levelCells);
+        }
+    }
+    return reached == seen.size();
+}
+
+} // namespace
+
+MazeLevels CarveMazeLevels(JobSystem& jobs, int width, int depth, int levelCount,
+                           bool randomOpenSpaces, uint32_t seed, int algorithm) {
+    PROFILE_ZONE("Carve Maze Levels");
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    const MazeAlgorithm& carver = *algorithms[std::clamp(algorithm, 0, static_cast<int>(algorithms.size()) - 1)];
+
+    MazeLevels maze;
+    levelCount = std::max(levelCount, 1);
+    maze.levels.resize(levelCount);
+    jobs.parallelFor(levelCount, [&](int level) {
+        carveLevel(maze.levels[level], width, depth, level, randomOpenSpaces, seed, carver);
+    });
+    if (width > 0 && depth > 0)
+        maze.stairwells = pickStairwells(width, depth, levelCount, seed);
+    return maze;
+}
+
+void GenerateMazeLevels(Map& mapBuffer, int width, int depth, int levelCount, float cellSize,
+                        float floorHeight, float levelHeight, const std::string& shaderBase,
+                        bool randomOpenSpaces, uint32_t seed, int algorithm) {
+    PROFILE_ZONE("Generate Maze Levels");
+    StopMazeStream(mapBuffer);  // Its chunks go with the clear
+    mapBuffer.clear();
+    levelHeight = std::max(levelHeight, MIN_LEVEL_HEIGHT);
+
+    JobSystem& jobs = GetJobSystem();
+    MazeLevels maze = CarveMazeLevels(jobs, width, depth, levelCount, randomOpenSpaces, seed, algorithm);
+    levelCount = static_cast<int>(maze.levels.size());
+
+    // Box building is the bigger half of the work, so it runs per level on the workers as well
+    std::vector<std::vector<MazeBox>> levelBoxes(levelCount);
+    jobs.parallelFor(levelCount, [&](int level) {
+        std::vector<uint8_t> floorCells(static_cast<size_t>(width) * depth, 1);
+        if (level > 0) {
+            const MazeLevels::Stairwell& below = maze.stairwells[level - 1];
+            floorCells[static_cast<size_t>(below.z) * width + below.x] = 0;
+        }
+        levelBoxes[level] = BuildMazeBoxes(maze.levels[level], cellSize, floorHeight + level * levelHeight, true,
+                                           &floorCells);
+    });
+
+    const std::string vert = shaderBase + ".vert", frag = shaderBase + ".frag";
+    for (const std::vector<MazeBox>& boxes : levelBoxes) {
+        for (const MazeBox& box : boxes)
+            mapBuffer.addObject(Map::MapObject(box.name, box.type, box.position, glm::vec3(0.0f), box.scale, vert, frag));
+    }
+
+    // Each stairwell is a flight of steps rising along +z to the level above
+    const float offsetX = -(width * cellSize) / 2.0f + cellSize / 2.0f;
+    const float offsetZ = -(depth * cellSize) / 2.0f + cellSize / 2.0f;
+    const float stepDepth = cellSize / STAIR_STEPS;
+    for (const MazeLevels::Stairwell& stairwell : maze.stairwells) {
+        const float baseY = floorHeight + stairwell.level * levelHeight;
+        const float cellX = offsetX + stairwell.x * cellSize;
+        const float cellZ = offsetZ + stairwell.z * cellSize - cellSize / 2.0f;
+        for (int step = 0; step < STAIR_STEPS; ++step) {
+            const float height = levelHeight * (step + 1) / STAIR_STEPS;
+            mapBuffer.addObject(Map::MapObject("stairs", "Cube",
+                                               glm::vec3(cellX, baseY + height / 2.0f, cellZ + (step + 0.5f) * stepDepth),
+                                               glm::vec3(0.0f), glm::vec3(cellSize * 0.8f, height, stepDepth), vert, frag));
+        }
+    }
+
+    std::cout << "Maze generated: " << levelCount << " levels of " << width << " x " << depth << " on "
+              << jobs.threadCount() << " worker thread(s) (seed " << seed << ")" << std::endl;
+}
+
+void BenchmarkMazeLevels() {
+    const int size = 250, levelCount = 32;
+    const uint32_t seed = 12345;
+    std::cout << "[Maze] Multi-level benchmark, " << levelCount << " levels of " << size << "x" << size
+              << " (seed " << seed << ")" << std::endl;
+
+    MazeLevels reference;
+    double singleThreadRate = 0.0;
+    for (unsigned threads : BenchmarkThreadCounts()) {
+        JobSystem pool(threads - 1);  // parallelFor runs on the calling thread too
+        std::atomic<size_t> boxCount{ 0 };
+
+        auto start = std::chrono::steady_clock::now();
+        MazeLevels maze = CarveMazeLevels(pool, size, size, levelCount, false, seed, 0);
+        pool.parallelFor(levelCount, [&](int level) {
+            boxCount += BuildMazeBoxes(maze.levels[level], 1.0f, 0.0f, true).size();
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double rate = levelCount / std::max(seconds, 1e-9);
+        if (threads == 1) {
+            singleThreadRate = rate;
+            reference = maze;
+        }
+        bool same = maze.levels == reference.levels;
+        std::cout << "  " << threads << " thread(s): " << rate << " levels/s (" << rate / singleThreadRate << "x), "
+                  << boxCount << " boxes, " << (same ? "same maze" : "DIFFERENT MAZE") << std::endl;
+    }
+    std::cout << "  stack " << (stackConnected(reference) ? "fully connected" : "NOT CONNECTED") << std::endl;
+}
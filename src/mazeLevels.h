@@ -0,0 +1,38 @@
+// mazeLevels.h
+#ifndef MAZE_LEVELS_H
+#define MAZE_LEVELS_H
+
+#include "mazeGen.h"
+#include "jobSystem.h"
+#include <cstdint>
+#include <vector>
+
+// A stack of maze levels joined by stairwells. Level i is carved from its own RNG stream,
+// seeded from (seed, i), so levels can be carved in any order on any number of threads and
+// still come out the same. Every level is connected on its own, so one stairwell between each
+// pair of adjacent levels keeps the whole stack connected.
+struct MazeLevels {
+    struct Stairwell {
+        int level;  // Stairs stand in this level and come up through the floor of level + 1
+        int x, z;
+    };
+
+    std::vector<MazeGrid> levels;
+    std::vector<Stairwell> stairwells;  // stairwells[i] joins level i and i + 1
+};
+
+MazeLevels CarveMazeLevels(JobSystem& jobs, int width, int depth, int levelCount,
+                           bool randomOpenSpaces, uint32_t seed, int algorithm);
+
+// Generates levelCount stacked mazes levelHeight apart and fills the provided map buffer.
+// Carving and box building run per level on the shared job system; the objects are added
+// on the calling thread since they create GL meshes.
+void GenerateMazeLevels(Map& mapBuffer, int width, int depth, int levelCount, float cellSize,
+                        float floorHeight, float levelHeight, const std::string& shaderBase,
+                        bool randomOpenSpaces, uint32_t seed, int algorithm = 0);
+
+// Carves a tall stack with 1..N worker threads, checks that every thread count gives the same
+// levels and that every cell of the stack is reachable, and prints levels/second
+void BenchmarkMazeLevels();
+
+#endif
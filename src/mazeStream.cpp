@@ -0,0 +1,224 @@
+#include "mazeStream.h"
+#include "ShapeFactory.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+
+int mazeStreamRowsAhead = 64;
+int mazeStreamRowsBehind = 32;
+
+void EllerMaze::reset(int width, uint32_t seed) {
+    w = std::max(width, 1);
+    rowCount = 0;
+    rng.seed(seed);
+    sets.assign(w, 0);
+    members.assign(2 * w + 1, 0);
+    opened.assign(2 * w + 1, 0);
+    parent.resize(2 * w + 1);
+}
+
+int EllerMaze::find(int label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+void EllerMaze::nextRow(std::vector<uint8_t>& rightWalls, std::vector<uint8_t>& downWalls) {
+    rightWalls.assign(w > 1 ? w - 1 : 0, 1);
+    downWalls.assign(w, 1);
+    std::bernoulli_distribution coin(0.5);
+
+    // Cells not carried down from the last row start their own set. Carried labels are 1..w,
+    // so w + 1 + x is always free.
+    for (int x = 0; x < w; ++x) {
+        if (sets[x] == 0)
+            sets[x] = w + 1 + x;
+    }
+
+    // Randomly join neighbours that are not connected yet. The left set's label survives, and
+    // every cell takes its set's label once the row is done.
+    for (size_t label = 0; label < parent.size(); ++label)
+        parent[label] = static_cast<int>(label);
+    for (int x = 0; x + 1 < w; ++x) {
+        const int left = find(sets[x]), right = find(sets[x + 1]);
+        if (left != right && coin(rng)) {
+            rightWalls[x] = 0;
+            parent[right] = left;
+        }
+    }
+    for (int x = 0; x < w; ++x)
+        sets[x] = find(sets[x]);
+
+    // Every set opens at least one way down, or it would be cut off from the rest of the maze
+    for (int x = 0; x < w; ++x)
+        ++members[sets[x]];
+    for (int x = 0; x < w; ++x) {
+        const int label = sets[x];
+        const bool last = --members[label] == 0;
+        if ((last && !opened[label]) || coin(rng)) {
+            downWalls[x] = 0;
+            opened[label] = 1;
+        }
+    }
+
+    // Carry the open cells' sets into the next row, relabelled to 1..w in order of appearance
+    int nextLabel = 0;
+    for (int x = 0; x < w; ++x) {
+        const int label = sets[x];
+        opened[label] = 0;
+        if (downWalls[x]) {
+            sets[x] = 0;
+            continue;
+        }
+        if (members[label] == 0)
+            members[label] = ++nextLabel;  // members is all zero again after the pass above
+        sets[x] = members[label];
+    }
+    std::fill(members.begin(), members.end(), 0);
+    ++rowCount;
+}
+
+namespace {
+
+struct MazeStreamState {
+    bool active = false;
+    EllerMaze maze;
+    float cellSize = 1.0f;
+    float floorHeight = 0.0f;
+    std::string shaderBase = "basic";
+    long long firstChunk = 0;  // Oldest chunk still in the map
+    long long nextChunk = 0;   // Next chunk to generate
+    std::vector<uint8_t> rightWalls, downWalls;
+};
+
+MazeStreamState stream;
+
+std::string chunkName(long long chunk) {
+    return "MazeStream_" + std::to_string(chunk);
+}
+
+// False for names that did not come from chunkName, e.g. a chunk renamed in the Inspector
+bool parseChunkName(const std::string& name, long long& chunk) {
+    const std::string prefix = "MazeStream_";
+    if (name.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    const char* first = name.data() + prefix.size();
+    const char* last = name.data() + name.size();
+    auto result = std::from_chars(first, last, chunk);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+void removeStreamChunks(Map& mapBuffer, long long firstChunk, long long endChunk) {
+    auto it = std::remove_if(mapBuffer.objects.begin(), mapBuffer.objects.end(), [&](Map::MapObject& obj) {
+        if (obj.type != "MazeStream")
+            return false;
+        long long chunk = 0;
+        if (!parseChunkName(obj.name, chunk) || chunk < firstChunk || chunk >= endChunk)
+            return false;
+        obj.mesh.destroy();
+        return true;
+    });
+    mapBuffer.objects.erase(it, mapBuffer.objects.end());
+}
+
+// Generates the next MAZE_STREAM_CHUNK_ROWS rows and uploads them as one object
+void buildNextChunk(Map& mapBuffer) {
+    const int width = stream.maze.width();
+    const float cs = stream.cellSize;
+    const float wallY = stream.floorHeight + 0.5f;
+    const float offsetX = -(width * cs) / 2.0f + cs / 2.0f;
+    const float centerX = offsetX + (width - 1) * cs / 2.0f;
+    const glm::vec3 depthWall(0.1f, 1.0f, cs);
+
+    std::vector<float> vertices;
+    for (int i = 0; i < MAZE_STREAM_CHUNK_ROWS; ++i) {
+        const long long row = stream.maze.rows();
+        const float z = row * cs;
+        stream.maze.nextRow(stream.rightWalls, stream.downWalls);
+
+        // One floor strip and the two outer walls per row
+        appendBox(vertices, glm::vec3(centerX, stream.floorHeight, z), glm::vec3(width * cs, 0.1f, cs));
+        appendBox(vertices, glm::vec3(offsetX - cs / 2.0f, wallY, z), depthWall);
+        appendBox(vertices, glm::vec3(offsetX + width * cs - cs / 2.0f, wallY, z), depthWall);
+        if (row == 0)
+            appendBox(vertices, glm::vec3(centerX, wallY, z - cs / 2.0f), glm::vec3(width * cs, 1.0f, 0.1f));
+
+        for (int x = 0; x + 1 < width; ++x) {
+            if (stream.rightWalls[x])
+                appendBox(vertices, glm::vec3(offsetX + x * cs + cs / 2.0f, wallY, z), depthWall);
+        }
+        // Runs of down walls become one box each
+        for (int x = 0; x < width;) {
+            if (!stream.downWalls[x]) {
+                ++x;
+                continue;
+            }
+            int end = x;
+            while (end < width && stream.downWalls[end])
+                ++end;
+            const float runCenter = offsetX + (x + end - 1) * cs / 2.0f;
+            appendBox(vertices, glm::vec3(runCenter, wallY, z + cs / 2.0f), glm::vec3((end - x) * cs, 1.0f, 0.1f));
+            x = end;
+        }
+    }
+
+    Map::MapObject obj(chunkName(stream.nextChunk), "MazeStream", glm::vec3(0.0f), glm::vec3(0.0f),
+                       glm::vec3(1.0f), stream.shaderBase + ".vert", stream.shaderBase + ".frag");
+    obj.mesh.setVertices(vertices);
+    mapBuffer.addObjectWithMesh(obj);
+    ++stream.nextChunk;
+}
+
+} // namespace
+
+void StartMazeStream(Map& mapBuffer, int width, float cellSize, float floorHeight,
+                     const std::string& shaderBase, uint32_t seed) {
+    StopMazeStream(mapBuffer);
+    stream.active = true;
+    stream.maze.reset(width, seed);
+    stream.cellSize = std::max(cellSize, 0.01f);
+    stream.floorHeight = floorHeight;
+    stream.shaderBase = shaderBase;
+    stream.firstChunk = 0;
+    stream.nextChunk = 0;
+    std::cout << "Maze stream started: width " << stream.maze.width() << " (seed " << seed << ")" << std::endl;
+}
+
+void StopMazeStream(Map& mapBuffer) {
+    if (!stream.active)
+        return;
+    removeStreamChunks(mapBuffer, stream.firstChunk, stream.nextChunk);
+    stream.active = false;
+}
+
+bool MazeStreamActive() {
+    return stream.active;
+}
+
+void UpdateMazeStream(Map& mapBuffer, const glm::vec3& cameraPosition) {
+    if (!stream.active)
+        return;
+
+    const long long cameraRow = std::max(0LL, static_cast<long long>(std::floor(cameraPosition.z / stream.cellSize + 0.5f)));
+
+    // A few chunks per frame at most, so walking quickly does not stall a frame
+    const int maxChunksPerFrame = 4;
+    for (int built = 0; built < maxChunksPerFrame && stream.maze.rows() < cameraRow + mazeStreamRowsAhead; ++built)
+        buildNextChunk(mapBuffer);
+
+    long long keepFrom = stream.firstChunk;
+    while (keepFrom < stream.nextChunk && (keepFrom + 1) * MAZE_STREAM_CHUNK_ROWS < cameraRow - mazeStreamRowsBehind)
+        ++keepFrom;
+    if (keepFrom != stream.firstChunk) {
+        removeStreamChunks(mapBuffer, stream.firstChunk, keepFrom);
+        stream.firstChunk = keepFrom;
+    }
+}
+
+long long MazeStreamRows() {
+    return stream.maze.rows();
+}
@@ -0,0 +1,51 @@
+// mazeStream.h
+#ifndef MAZE_STREAM_H
+#define MAZE_STREAM_H
+
+#include "map.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Eller's algorithm: carves a maze of fixed width one row at a time, keeping only the current
+// row's set labels, so memory stays O(width) however many rows are produced.
+class EllerMaze {
+public:
+    void reset(int width, uint32_t seed);
+
+    // Carves the next row. rightWalls[x] is the wall between cells x and x + 1 of this row,
+    // downWalls[x] the wall between cell x and the row after it.
+    void nextRow(std::vector<uint8_t>& rightWalls, std::vector<uint8_t>& downWalls);
+
+    int width() const { return w; }
+    long long rows() const { return rowCount; }
+
+private:
+    int w = 0;
+    long long rowCount = 0;
+    std::mt19937 rng;
+    std::vector<int> sets;     // Set label per cell of the current row (1..2*width), 0 = none yet
+    std::vector<int> members;  // Scratch indexed by label
+    std::vector<uint8_t> opened;
+    std::vector<int> parent;   // Union-find over labels while a row is joined
+
+    int find(int label);
+};
+
+// Streams an Eller maze into the map as the camera walks along +z: rows are generated ahead of
+// the camera in chunks of MAZE_STREAM_CHUNK_ROWS, each uploaded as one MapObject, and chunks far
+// behind are dropped. The maze cannot be regenerated backwards, so the trail behind is lost.
+constexpr int MAZE_STREAM_CHUNK_ROWS = 16;
+
+extern int mazeStreamRowsAhead;   // Rows kept generated in front of the camera
+extern int mazeStreamRowsBehind;  // Rows kept behind it before chunks are dropped
+
+void StartMazeStream(Map& mapBuffer, int width, float cellSize, float floorHeight,
+                     const std::string& shaderBase, uint32_t seed);
+void StopMazeStream(Map& mapBuffer);
+bool MazeStreamActive();
+// Extends or trims the streamed maze around the camera; cheap when nothing needs to change
+void UpdateMazeStream(Map& mapBuffer, const glm::vec3& cameraPosition);
+long long MazeStreamRows();  // Rows generated so far
+
+#endif
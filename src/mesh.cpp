@@ -1,13 +1,21 @@
 #include "mesh.h"
 #include <iostream>
 #include "ShapeFactory.h"
+#include "gpuProfiler.h"
 #include <unordered_map>
 #include <functional>
 Mesh::Mesh() : VAO(0), VBO(0), vertexCount(0) {}
 
-void Mesh::setVertices(const std::vector<float>& data) {
+void Mesh::setVertices(const std::vector<float>& data, int floatsPerVertex) {
     vertices = data;
-    vertexCount = static_cast<GLsizei>(vertices.size() / 6); // 3 pos + 3 normal
+    stride = floatsPerVertex;
+    vertexCount = static_cast<GLsizei>(vertices.size() / stride); // 3 pos + 3 normal (+ extras)
+    boundsMin = boundsMax = glm::vec3(0.0f);
+    for (GLsizei i = 0; i < vertexCount; ++i) {
+        const glm::vec3 pos(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+        boundsMin = i == 0 ? pos : glm::min(boundsMin, pos);
+        boundsMax = i == 0 ? pos : glm::max(boundsMax, pos);
+    }
     initBuffers();
 }
 
@@ -20,16 +28,31 @@ void Mesh::initBuffers() {
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
 
     // Position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
     // Normal
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    // Two extra floats (voxel sky/block light)
+    if (stride >= 8) {
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+    }
+
     glBindVertexArray(0);
 }
 
+void Mesh::destroy() {
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    VAO = 0;
+    VBO = 0;
+    vertexCount = 0;
+    vertices.clear();
+}
+
 Mesh generateMeshForType(const std::string& type, float scale) {
     static const std::unordered_map<std::string, std::function<Mesh(float)>> meshGenerators = {
         { "Cube",    createCube },
@@ -55,5 +78,7 @@ void Mesh::render() const {
     glBindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, vertexCount);
     glBindVertexArray(0);
+    GpuProfiler::CountStateChange(2);
+    GpuProfiler::CountDraw(vertexCount / 3);
 }
 
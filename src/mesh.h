@@ -10,13 +10,17 @@
 class Mesh {
 public:
     Mesh();
-    void setVertices(const std::vector<float>& data);
+    void setVertices(const std::vector<float>& data, int floatsPerVertex = 6);
     void render() const;
+    void destroy();  // Frees the GPU buffers; copies sharing them become invalid
+    size_t byteSize() const { return static_cast<size_t>(vertexCount) * stride * sizeof(float); }  // Vertex buffer size
     GLuint VAO, VBO;
+    glm::vec3 boundsMin{ 0.0f }, boundsMax{ 0.0f };  // Local-space box around every vertex
     
 private:
     std::vector<float> vertices;
     GLsizei vertexCount = 0;
+    int stride = 6;  // Floats per vertex; 8 adds attribute 2
     void initBuffers();  // Needed to upload data to GPU
 };
 
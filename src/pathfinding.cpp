@@ -0,0 +1,556 @@
+#include "pathfinding.h"
+#include "debugDraw.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+void NavGrid::reset(int width, int depth) {
+    w = std::max(width, 0);
+    d = std::max(depth, 0);
+    moves.assign(static_cast<size_t>(w) * d, 0);
+}
+
+void NavGrid::setOpen(int x, int z, int direction, bool open) {
+    const int nx = x + NAV_DX[direction], nz = z + NAV_DZ[direction];
+    if (!inBounds(x, z) || !inBounds(nx, nz))
+        return;
+    const int back = (direction + 2) & 3;
+    uint8_t& from = moves[static_cast<size_t>(z) * w + x];
+    uint8_t& to = moves[static_cast<size_t>(nz) * w + nx];
+    if (open) {
+        from |= uint8_t(1 << direction);
+        to |= uint8_t(1 << back);
+    } else {
+        from &= uint8_t(~(1 << direction));
+        to &= uint8_t(~(1 << back));
+    }
+}
+
+NavGrid NavGridFromMaze(const MazeGrid& maze, float cellSize, float floorHeight) {
+    NavGrid grid;
+    grid.reset(maze.width(), maze.depth());
+    grid.cellSize = cellSize;
+    grid.origin = glm::vec3(-(maze.width() * cellSize) / 2.0f + cellSize / 2.0f, floorHeight,
+                            -(maze.depth() * cellSize) / 2.0f + cellSize / 2.0f);
+    for (int z = 0; z < maze.depth(); ++z) {
+        for (int x = 0; x < maze.width(); ++x) {
+            // Right and down cover every inner wall once
+            if (x + 1 < maze.width() && !maze.hasWall(x, z, 1)) grid.setOpen(x, z, 1, true);
+            if (z + 1 < maze.depth() && !maze.hasWall(x, z, 2)) grid.setOpen(x, z, 2, true);
+        }
+    }
+    return grid;
+}
+
+NavGrid NavGridFromMap(const Map& mapBuffer, float resolution, float floorHeight) {
+    const float slabThickness = 0.25f;  // Thicker than this and an object is in the way
+    const float bandBottom = floorHeight - slabThickness, bandTop = floorHeight + 1.0f;
+    const int maxCells = 4096;
+    resolution = std::max(resolution, 0.01f);
+
+    struct Bounds { glm::vec3 min, max; };
+    std::vector<Bounds> floors, obstacles;
+    for (const Map::MapObject& obj : mapBuffer.objects) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), obj.position);
+        model = glm::rotate(model, glm::radians(obj.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(obj.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(obj.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, obj.scale);
+        Bounds b{ glm::vec3(INFINITY), glm::vec3(-INFINITY) };
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 corner((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+            glm::vec3 p = glm::vec3(model * glm::vec4(corner, 1.0f));
+            b.min = glm::min(b.min, p);
+            b.max = glm::max(b.max, p);
+        }
+        if (b.max.y < bandBottom || b.min.y > bandTop)
+            continue;
+        if (b.max.y - b.min.y <= slabThickness)
+            floors.push_back(b);
+        else
+            obstacles.push_back(b);
+    }
+
+    NavGrid grid;
+    if (floors.empty()) {
+        grid.reset(0, 0);
+        return grid;
+    }
+    glm::vec3 lo(INFINITY), hi(-INFINITY);
+    for (const Bounds& b : floors) {
+        lo = glm::min(lo, b.min);
+        hi = glm::max(hi, b.max);
+    }
+    const int width = std::clamp(static_cast<int>(std::ceil((hi.x - lo.x) / resolution)), 1, maxCells);
+    const int depth = std::clamp(static_cast<int>(std::ceil((hi.z - lo.z) / resolution)), 1, maxCells);
+    grid.reset(width, depth);
+    grid.cellSize = resolution;
+    grid.origin = glm::vec3(lo.x + resolution / 2.0f, floorHeight, lo.z + resolution / 2.0f);
+
+    // Rasterise each object over the cells it touches rather than testing every cell against every object
+    std::vector<uint8_t> walkable(static_cast<size_t>(width) * depth, 0);
+    auto cellRange = [&](float minV, float maxV, float lowV, int count, bool centres, int& first, int& last) {
+        if (centres) {
+            first = static_cast<int>(std::ceil((minV - lowV) / resolution - 0.5f));
+            last = static_cast<int>(std::floor((maxV - lowV) / resolution - 0.5f));
+        } else {
+            // Touching a cell edge is not overlapping it; the slack absorbs rounding on exact edges
+            first = static_cast<int>(std::floor((minV - lowV) / resolution + 1e-3f));
+            last = static_cast<int>(std::ceil((maxV - lowV) / resolution - 1e-3f)) - 1;
+        }
+        first = std::max(first, 0);
+        last = std::min(last, count - 1);
+    };
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool floorPass = pass == 0;
+        for (const Bounds& b : floorPass ? floors : obstacles) {
+            int x0, x1, z0, z1;
+            cellRange(b.min.x, b.max.x, lo.x, width, floorPass, x0, x1);
+            cellRange(b.min.z, b.max.z, lo.z, depth, floorPass, z0, z1);
+            for (int z = z0; z <= z1; ++z)
+                std::fill(walkable.begin() + static_cast<size_t>(z) * width + x0,
+                          walkable.begin() + static_cast<size_t>(z) * width + std::max(x0, x1 + 1), floorPass ? 1 : 0);
+        }
+    }
+
+    for (int z = 0; z < depth; ++z) {
+        for (int x = 0; x < width; ++x) {
+            if (!walkable[static_cast<size_t>(z) * width + x])
+                continue;
+            if (x + 1 < width && walkable[static_cast<size_t>(z) * width + x + 1]) grid.setOpen(x, z, 1, true);
+            if (z + 1 < depth && walkable[static_cast<size_t>(z + 1) * width + x]) grid.setOpen(x, z, 2, true);
+        }
+    }
+    return grid;
+}
+
+namespace {
+
+struct OpenNode {
+    uint32_t f, g;
+    int cell;
+    bool operator<(const OpenNode& other) const {
+        // priority_queue pops the largest, so invert: lowest f first, deeper g on ties
+        return f != other.f ? f > other.f : g < other.g;
+    }
+};
+
+uint32_t manhattan(int a, int b, int width) {
+    return static_cast<uint32_t>(std::abs(a % width - b % width) + std::abs(a / width - b / width));
+}
+
+bool validQuery(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal) {
+    return grid.inBounds(start.x, start.y) && grid.inBounds(goal.x, goal.y);
+}
+
+// Fills path.cells from goal back to start through parents, which lie on straight lines
+void tracePath(const NavGrid& grid, const std::vector<int>& parent, int startCell, int goalCell, PathResult& path) {
+    const int width = grid.width();
+    path.found = true;
+    for (int cell = goalCell;; cell = parent[cell]) {
+        const int next = cell == startCell ? cell : parent[cell];
+        int x = cell % width, z = cell / width;
+        const int nx = next % width, nz = next / width;
+        do {
+            path.cells.push_back(glm::ivec2(x, z));
+            x += (nx > x) - (nx < x);
+            z += (nz > z) - (nz < z);
+        } while (x != nx || z != nz);
+        if (cell == startCell)
+            break;
+    }
+    std::reverse(path.cells.begin(), path.cells.end());
+}
+
+} // namespace
+
+PathResult FindPathAStar(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal) {
+    PathResult path;
+    if (!validQuery(grid, start, goal))
+        return path;
+
+    const int width = grid.width();
+    const int startCell = start.y * width + start.x, goalCell = goal.y * width + goal.x;
+    std::vector<uint32_t> g(static_cast<size_t>(width) * grid.depth(), FlowField::UNREACHABLE);
+    std::vector<int> parent(g.size(), -1);
+    std::priority_queue<OpenNode> open;
+    g[startCell] = 0;
+    open.push({ manhattan(startCell, goalCell, width), 0, startCell });
+
+    while (!open.empty()) {
+        const OpenNode node = open.top();
+        open.pop();
+        if (node.g != g[node.cell])
+            continue;  // Stale entry, a shorter way was found after it was pushed
+        ++path.expanded;
+        if (node.cell == goalCell) {
+            tracePath(grid, parent, startCell, goalCell, path);
+            return path;
+        }
+        const int x = node.cell % width, z = node.cell / width;
+        const uint8_t sides = grid.openSides(x, z);
+        for (int direction = 0; direction < 4; ++direction) {
+            if (!((sides >> direction) & 1))
+                continue;
+            const int next = node.cell + NAV_DZ[direction] * width + NAV_DX[direction];
+            if (node.g + 1 < g[next]) {
+                g[next] = node.g + 1;
+                parent[next] = node.cell;
+                open.push({ node.g + 1 + manhattan(next, goalCell, width), node.g + 1, next });
+            }
+        }
+    }
+    return path;
+}
+
+namespace {
+
+class JumpSearch {
+public:
+    JumpSearch(const NavGrid& grid, int goalCell) : grid(grid), width(grid.width()), goalCell(goalCell) {}
+
+    // Next jump point straight on from (x, z), or -1 when the run ends in a wall
+    int jump(int x, int z, int direction) const {
+        return (direction & 1) ? jumpHorizontal(x, z, direction) : jumpVertical(x, z, direction);
+    }
+
+    // A vertical run stops where a side opening cannot also be reached by stepping sideways
+    // one cell earlier, since that route would come first in the canonical order
+    bool forcedSide(int x, int z, int vertical, int side) const {
+        const int px = x - NAV_DX[vertical], pz = z - NAV_DZ[vertical];
+        return grid.canMove(x, z, side) && !(grid.canMove(px, pz, side) && grid.canMove(px + NAV_DX[side], pz, vertical));
+    }
+
+private:
+    const NavGrid& grid;
+    int width;
+    int goalCell;
+
+    int jumpVertical(int x, int z, int direction) const {
+        while (grid.canMove(x, z, direction)) {
+            z += NAV_DZ[direction];
+            const int cell = z * width + x;
+            if (cell == goalCell || forcedSide(x, z, direction, 1) || forcedSide(x, z, direction, 3))
+                return cell;
+        }
+        return -1;
+    }
+
+    // Vertical turns are natural after a horizontal step, so a cell is a jump point as soon as
+    // either vertical run from it leads somewhere
+    int jumpHorizontal(int x, int z, int direction) const {
+        while (grid.canMove(x, z, direction)) {
+            x += NAV_DX[direction];
+            const int cell = z * width + x;
+            if (cell == goalCell || jumpVertical(x, z, 0) >= 0 || jumpVertical(x, z, 2) >= 0)
+                return cell;
+        }
+        return -1;
+    }
+};
+
+} // namespace
+
+PathResult FindPathJPS(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal) {
+    PathResult path;
+    if (!validQuery(grid, start, goal))
+        return path;
+
+    const int width = grid.width();
+    const int startCell = start.y * width + start.x, goalCell = goal.y * width + goal.x;
+    const JumpSearch search(grid, goalCell);
+    std::vector<uint32_t> g(static_cast<size_t>(width) * grid.depth(), FlowField::UNREACHABLE);
+    std::vector<int> parent(g.size(), -1);
+    std::vector<uint8_t> arrival(g.size(), FlowField::NO_DIRECTION);
+    std::priority_queue<OpenNode> open;
+    g[startCell] = 0;
+    open.push({ manhattan(startCell, goalCell, width), 0, startCell });
+
+    while (!open.empty()) {
+        const OpenNode node = open.top();
+        open.pop();
+        if (node.g != g[node.cell])
+            continue;
+        ++path.expanded;
+        if (node.cell == goalCell) {
+            tracePath(grid, parent, startCell, goalCell, path);
+            return path;
+        }
+
+        const int x = node.cell % width, z = node.cell / width;
+        const uint8_t from = arrival[node.cell];
+        uint8_t directions;
+        if (from == FlowField::NO_DIRECTION)
+            directions = 0xF;
+        else if (from & 1)
+            directions = uint8_t((1 << from) | 0x5);  // Straight on, up and down
+        else
+            directions = uint8_t((1 << from) | (search.forcedSide(x, z, from, 1) ? 0x2 : 0) |
+                                 (search.forcedSide(x, z, from, 3) ? 0x8 : 0));
+
+        for (int direction = 0; direction < 4; ++direction) {
+            if (!((directions >> direction) & 1))
+                continue;
+            const int next = search.jump(x, z, direction);
+            if (next < 0)
+                continue;
+            const uint32_t nextG = node.g + manhattan(node.cell, next, width);
+            if (nextG < g[next]) {
+                g[next] = nextG;
+                parent[next] = node.cell;
+                arrival[next] = static_cast<uint8_t>(direction);
+                open.push({ nextG + manhattan(next, goalCell, width), nextG, next });
+            }
+        }
+    }
+    return path;
+}
+
+PathResult FlowField::follow(glm::ivec2 start) const {
+    PathResult path;
+    if (start.x < 0 || start.y < 0 || start.x >= width || start.y >= depth || distanceAt(start.x, start.y) == UNREACHABLE)
+        return path;
+    path.found = true;
+    glm::ivec2 cell = start;
+    path.cells.push_back(cell);
+    while (cell != goal) {
+        const uint8_t step = direction[static_cast<size_t>(cell.y) * width + cell.x];
+        cell += glm::ivec2(NAV_DX[step], NAV_DZ[step]);
+        path.cells.push_back(cell);
+    }
+    return path;
+}
+
+void ComputeFlowField(const NavGrid& grid, glm::ivec2 goal, FlowField& field, JobSystem& jobs) {
+    const int width = grid.width(), depth = grid.depth();
+    const size_t count = static_cast<size_t>(width) * depth;
+    field.width = width;
+    field.depth = depth;
+    field.goal = goal;
+    field.reachable = 0;
+    field.distance.assign(count, FlowField::UNREACHABLE);
+    field.direction.assign(count, FlowField::NO_DIRECTION);
+    if (!grid.inBounds(goal.x, goal.y))
+        return;
+
+    // Cells are claimed through an atomic visited bitmap so the winner alone writes the distance
+    std::vector<std::atomic<uint64_t>> visited((count + 63) / 64);
+    for (auto& word : visited)
+        word.store(0, std::memory_order_relaxed);
+    auto claim = [&](int cell) {
+        const uint64_t bit = uint64_t(1) << (cell & 63);
+        return !(visited[cell >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+    };
+    auto expand = [&](int cell, uint32_t level, std::vector<int>& out) {
+        const uint8_t sides = grid.openSides(cell % width, cell / width);
+        for (int direction = 0; direction < 4; ++direction) {
+            if (!((sides >> direction) & 1))
+                continue;
+            const int next = cell + NAV_DZ[direction] * width + NAV_DX[direction];
+            if (claim(next)) {
+                field.distance[next] = level;
+                out.push_back(next);
+            }
+        }
+    };
+
+    // Narrow fronts (most of a maze) are cheaper on one thread than handing out
+    const size_t parallelFront = 4096, blockSize = 1024;
+    std::vector<int> front{ goal.y * width + goal.x }, nextFront;
+    std::vector<std::vector<int>> blockOut;
+    claim(front[0]);
+    field.distance[front[0]] = 0;
+    for (uint32_t level = 1; !front.empty(); ++level) {
+        nextFront.clear();
+        if (front.size() < parallelFront || jobs.threadCount() < 2) {
+            for (int cell : front)
+                expand(cell, level, nextFront);
+        } else {
+            const int blocks = static_cast<int>((front.size() + blockSize - 1) / blockSize);
+            blockOut.resize(blocks);
+            jobs.parallelFor(blocks, [&](int block) {
+                blockOut[block].clear();
+                const size_t end = std::min(front.size(), (block + 1) * blockSize);
+                for (size_t i = block * blockSize; i < end; ++i)
+                    expand(front[i], level, blockOut[block]);
+            });
+            for (int block = 0; block < blocks; ++block)
+                nextFront.insert(nextFront.end(), blockOut[block].begin(), blockOut[block].end());
+        }
+        std::swap(front, nextFront);
+    }
+
+    // Each reached cell points at a neighbour one step closer
+    std::atomic<size_t> reachable{ 0 };
+    jobs.parallelFor(depth, [&](int z) {
+        size_t rowReachable = 0;
+        for (int x = 0; x < width; ++x) {
+            const size_t cell = static_cast<size_t>(z) * width + x;
+            const uint32_t distance = field.distance[cell];
+            if (distance == FlowField::UNREACHABLE)
+                continue;
+            ++rowReachable;
+            const uint8_t sides = grid.openSides(x, z);
+            for (int direction = 0; direction < 4 && distance > 0; ++direction) {
+                if (((sides >> direction) & 1) &&
+                    field.distance[cell + NAV_DZ[direction] * width + NAV_DX[direction]] == distance - 1) {
+                    field.direction[cell] = static_cast<uint8_t>(direction);
+                    break;
+                }
+            }
+        }
+        reachable += rowReachable;
+    });
+    field.reachable = reachable;
+}
+
+PathResult FindCriticalPath(const NavGrid& grid, glm::ivec2 seed, JobSystem& jobs) {
+    // Two sweeps: the cell farthest from anywhere is one end of the longest path in a tree
+    auto farthest = [&](const FlowField& field) {
+        glm::ivec2 best = field.goal;
+        uint32_t bestDistance = 0;
+        for (int z = 0; z < field.depth; ++z) {
+            for (int x = 0; x < field.width; ++x) {
+                const uint32_t distance = field.distanceAt(x, z);
+                if (distance != FlowField::UNREACHABLE && distance > bestDistance) {
+                    bestDistance = distance;
+                    best = glm::ivec2(x, z);
+                }
+            }
+        }
+        return best;
+    };
+
+    FlowField field;
+    ComputeFlowField(grid, seed, field, jobs);
+    if (field.reachable == 0)
+        return PathResult();
+    const glm::ivec2 end = farthest(field);
+    ComputeFlowField(grid, end, field, jobs);
+    return field.follow(farthest(field));
+}
+
+void DrawPath(const NavGrid& grid, const PathResult& path, const glm::vec3& color) {
+    const glm::vec3 lift(0.0f, 0.1f, 0.0f);  // Just above the floor slab
+    for (size_t i = 1; i < path.cells.size(); ++i) {
+        DebugDraw::Line(grid.cellCenter(path.cells[i - 1].x, path.cells[i - 1].y) + lift,
+                        grid.cellCenter(path.cells[i].x, path.cells[i].y) + lift, color);
+    }
+}
+
+void DrawFlowField(const NavGrid& grid, const FlowField& field) {
+    if (field.width != grid.width() || field.depth != grid.depth())
+        return;
+    uint32_t maxDistance = 1;
+    for (uint32_t distance : field.distance) {
+        if (distance != FlowField::UNREACHABLE)
+            maxDistance = std::max(maxDistance, distance);
+    }
+    const glm::vec3 lift(0.0f, 0.08f, 0.0f);
+    for (int z = 0; z < field.depth; ++z) {
+        for (int x = 0; x < field.width; ++x) {
+            const uint8_t step = field.direction[static_cast<size_t>(z) * field.width + x];
+            if (step == FlowField::NO_DIRECTION)
+                continue;
+            // Near the goal is green, far from it red; each cell gets a short stroke towards its next step
+            const float t = static_cast<float>(field.distanceAt(x, z)) / maxDistance;
+            const glm::vec3 center = grid.cellCenter(x, z) + lift;
+            const glm::vec3 towards(NAV_DX[step] * grid.cellSize * 0.4f, 0.0f, NAV_DZ[step] * grid.cellSize * 0.4f);
+            DebugDraw::Line(center, center + towards, glm::vec3(t, 1.0f - t, 0.2f));
+        }
+    }
+}
+
+void BenchmarkPathfinding() {
+    const int size = 1000, queries = 20;
+    const uint32_t seed = 12345;
+    std::cout << "[Path] Pathfinding benchmark, " << size << "x" << size << ", " << queries
+              << " random queries per grid (seed " << seed << ")" << std::endl;
+
+    // A perfect maze, and an open grid with a quarter of the cells blocked
+    NavGrid maze = NavGridFromMaze(CarveMazeGrid(size, size, false, seed), 1.0f, 0.0f);
+    NavGrid scattered;
+    scattered.reset(size, size);
+    {
+        std::mt19937 rng(seed);
+        std::bernoulli_distribution blocked(0.25);
+        std::vector<uint8_t> walkable(static_cast<size_t>(size) * size);
+        for (auto& cell : walkable)
+            cell = !blocked(rng);
+        for (int z = 0; z < size; ++z) {
+            for (int x = 0; x < size; ++x) {
+                if (!walkable[static_cast<size_t>(z) * size + x])
+                    continue;
+                if (x + 1 < size && walkable[static_cast<size_t>(z) * size + x + 1]) scattered.setOpen(x, z, 1, true);
+                if (z + 1 < size && walkable[static_cast<size_t>(z + 1) * size + x]) scattered.setOpen(x, z, 2, true);
+            }
+        }
+    }
+
+    const std::pair<const char*, const NavGrid*> grids[] = { { "maze", &maze }, { "scattered", &scattered } };
+    for (const auto& [gridName, grid] : grids) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> cellDist(0, size - 1);
+        auto randomOpenCell = [&]() {
+            glm::ivec2 cell;
+            do {
+                cell = glm::ivec2(cellDist(rng), cellDist(rng));
+            } while (grid->openSides(cell.x, cell.y) == 0);
+            return cell;
+        };
+        std::vector<std::pair<glm::ivec2, glm::ivec2>> pairs;
+        for (int i = 0; i < queries; ++i) {
+            const glm::ivec2 from = randomOpenCell();
+            pairs.push_back({ from, randomOpenCell() });
+        }
+
+        std::vector<int> aStarLengths;
+        int mismatches = 0;
+        for (int method = 0; method < 2; ++method) {
+            size_t expanded = 0, found = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < queries; ++i) {
+                PathResult path = method == 0 ? FindPathAStar(*grid, pairs[i].first, pairs[i].second)
+                                              : FindPathJPS(*grid, pairs[i].first, pairs[i].second);
+                expanded += path.expanded;
+                found += path.found;
+                const int length = path.found ? path.length() : -1;
+                if (method == 0)
+                    aStarLengths.push_back(length);
+                else if (length != aStarLengths[i])
+                    ++mismatches;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << gridName << ", " << (method == 0 ? "A*" : "JPS") << ": "
+                      << queries / std::max(seconds, 1e-9) << " queries/s, " << expanded / queries
+                      << " nodes expanded per query, " << found << "/" << queries << " found" << std::endl;
+        }
+        std::cout << "  " << gridName << ", JPS path lengths " << (mismatches == 0 ? "match A*" : "DIFFER FROM A*")
+                  << std::endl;
+    }
+
+    for (const auto& [gridName, grid] : grids) {
+        double singleThreadRate = 0.0;
+        for (unsigned threads : BenchmarkThreadCounts()) {
+            JobSystem pool(threads - 1);  // parallelFor runs on the calling thread too
+            FlowField field;
+            const int fields = 5;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < fields; ++i)
+                ComputeFlowField(*grid, glm::ivec2(size / 2, size / 2), field, pool);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double rate = fields / std::max(seconds, 1e-9);
+            if (threads == 1)
+                singleThreadRate = rate;
+            std::cout << "  " << gridName << ", flow field on " << threads << " thread(s): " << rate << " fields/s ("
+                      << rate / singleThreadRate << "x), " << field.reachable << " cells reachable" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+// pathfinding.h
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include "mazeGen.h"
+#include "jobSystem.h"
+#include "map.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// 4-connected grid of cells with a bit per open side (directions as in MazeGrid::hasWall).
+// Moves are kept symmetric: opening a side opens it from the neighbour as well.
+class NavGrid {
+public:
+    void reset(int width, int depth);  // Every side closed
+
+    int width() const { return w; }
+    int depth() const { return d; }
+    bool inBounds(int x, int z) const { return x >= 0 && z >= 0 && x < w && z < d; }
+
+    bool canMove(int x, int z, int direction) const { return (moves[static_cast<size_t>(z) * w + x] >> direction) & 1; }
+    uint8_t openSides(int x, int z) const { return moves[static_cast<size_t>(z) * w + x]; }
+    void setOpen(int x, int z, int direction, bool open);
+
+    glm::vec3 cellCenter(int x, int z) const { return origin + glm::vec3(x * cellSize, 0.0f, z * cellSize); }
+
+    glm::vec3 origin{ 0.0f };  // World centre of cell (0, 0)
+    float cellSize = 1.0f;
+
+private:
+    int w = 0, d = 0;
+    std::vector<uint8_t> moves;
+};
+
+// Cell step per direction: 0 up (-z), 1 right (+x), 2 down (+z), 3 left (-x)
+constexpr int NAV_DX[4] = { 0, 1, 0, -1 };
+constexpr int NAV_DZ[4] = { -1, 0, 1, 0 };
+
+// Walls of a carved maze, placed where BuildMazeBoxes puts its cells
+NavGrid NavGridFromMaze(const MazeGrid& maze, float cellSize, float floorHeight);
+// Walkability of any map at the given resolution: a cell is walkable when its centre is over a
+// thin slab (a floor) and no taller object overlaps it. Only objects within about a wall's
+// height of floorHeight count, so one level of a stacked maze can be picked out. Objects are
+// treated as unit cubes under their transform, which matches every built-in shape closely enough.
+NavGrid NavGridFromMap(const Map& mapBuffer, float resolution, float floorHeight);
+
+struct PathResult {
+    bool found = false;
+    std::vector<glm::ivec2> cells;  // Start to goal, every cell on the way
+    size_t expanded = 0;            // Nodes taken off the open list
+    int length() const { return cells.empty() ? 0 : static_cast<int>(cells.size()) - 1; }
+};
+
+PathResult FindPathAStar(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal);
+// Jump point search for 4-connected grids with walls between cells. Paths are searched in a
+// canonical order (horizontal before vertical), so straight corridors and open runs are crossed
+// in one jump instead of one node per cell. Gives paths as short as A*.
+PathResult FindPathJPS(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal);
+
+// Distance to the goal from every cell (a Dijkstra map) and the step that leads towards it.
+// Filled by a level-synchronous breadth-first search whose wide fronts are split across the
+// job system, then a parallel pass over rows for the directions.
+struct FlowField {
+    static constexpr uint32_t UNREACHABLE = 0xFFFFFFFFu;
+    static constexpr uint8_t NO_DIRECTION = 0xFF;
+
+    int width = 0, depth = 0;
+    glm::ivec2 goal{ 0 };
+    std::vector<uint32_t> distance;
+    std::vector<uint8_t> direction;
+    size_t reachable = 0;  // Cells with a way to the goal, the goal included
+
+    uint32_t distanceAt(int x, int z) const { return distance[static_cast<size_t>(z) * width + x]; }
+    PathResult follow(glm::ivec2 start) const;  // Walks the directions from start to the goal
+};
+void ComputeFlowField(const NavGrid& grid, glm::ivec2 goal, FlowField& field, JobSystem& jobs);
+
+// Longest shortest path from the cell farthest from seed. Exact for perfect mazes (trees);
+// for mazes with loops it is a lower bound on the true critical path.
+PathResult FindCriticalPath(const NavGrid& grid, glm::ivec2 seed, JobSystem& jobs);
+
+// Overlay lines, queued for the next DebugDraw::Flush
+void DrawPath(const NavGrid& grid, const PathResult& path, const glm::vec3& color);
+void DrawFlowField(const NavGrid& grid, const FlowField& field);
+
+// A* and JPS queries/second between random cells of a 1000x1000 maze and a 1000x1000 grid with
+// scattered obstacles, checking both find equally long paths, then flow fields on 1..N threads
+void BenchmarkPathfinding();
+
+#endif
@@ -0,0 +1,332 @@
+#include "renderBenchmark.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "map.h"
+#include "mazeGen.h"
+#include "voxel.h"
+#include "voxelBrush.h"
+#include "voxelRenderer.h"
+#include "editorCamera.h"
+#include "shader_utility.h"
+#include "gpuProfiler.h"
+
+namespace {
+
+constexpr int WARMUP_FRAMES = 30;        // After every shader has linked and every chunk is meshed
+constexpr double SETTLE_TIMEOUT = 60.0;  // Seconds to wait for that before measuring anyway
+
+struct FrameTotals {
+    double drawCalls = 0, triangles = 0, stateChanges = 0;
+};
+
+// Process memory from /proc on Linux; -1 elsewhere
+void readProcessMemory(long long& residentKB, long long& peakKB) {
+    residentKB = peakKB = -1;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) residentKB = std::atoll(line.c_str() + 6);
+        else if (line.compare(0, 6, "VmHWM:") == 0) peakKB = std::atoll(line.c_str() + 6);
+    }
+}
+
+// Rolling hills of seeded sine waves, so every seed gives a different but repeatable terrain
+void buildVoxelScene(VoxelMap& vmap, int size, uint32_t seed) {
+    vmap.layout = VoxelLayout::Cube;
+    vmap.resize(size, std::max(size / 2, 4), size);
+    float phase[4];
+    for (int i = 0; i < 4; ++i)
+        phase[i] = static_cast<float>((seed * 2654435761u + i * 40503u) % 6283u) / 1000.0f;
+
+    const Voxel ground{ VoxelType::Solid, "voxel_lit" };
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            float h = 0.5f + 0.2f * std::sin(x * 0.11f + phase[0]) + 0.15f * std::sin(z * 0.07f + phase[1])
+                    + 0.1f * std::sin((x + z) * 0.23f + phase[2]) * std::cos((x - z) * 0.13f + phase[3]);
+            int top = std::clamp(static_cast<int>(h * (vmap.height - 1)), 0, vmap.height - 1);
+            FillVoxelBox(vmap, x, 0, z, x, top, z, ground);
+        }
+    }
+}
+
+bool buildScene(const RenderBenchmarkOptions& options, Map& map, VoxelMap& vmap) {
+    if (!options.mapPath.empty()) {
+        bool loaded = std::filesystem::path(options.mapPath).extension() == ".txt"
+            ? map.loadFromTextFile(options.mapPath)
+            : map.loadFromBinaryFile(options.mapPath);
+        if (!loaded)
+            std::cerr << "Benchmark: could not load map " << options.mapPath << std::endl;
+        return loaded;
+    }
+    if (options.scene == "maze") {
+        GenerateMaze(map, options.size, options.size, 1.0f, 0.0f, options.shaderBase, true, options.seed);
+        return true;
+    }
+    if (options.scene == "voxel") {
+        buildVoxelScene(vmap, options.size, options.seed);
+        GenerateVoxelObjects(vmap, map);
+        return true;
+    }
+    std::cerr << "Benchmark: unknown scene '" << options.scene << "' (use maze or voxel)" << std::endl;
+    return false;
+}
+
+// Centre and radius of every object's bounds, for framing the camera path
+void sceneBounds(const Map& map, glm::vec3& center, float& radius) {
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (const auto& obj : map.objects) {
+        glm::vec3 halfSize = 0.5f * (obj.mesh.boundsMax - obj.mesh.boundsMin) * glm::abs(obj.scale);
+        glm::vec3 mid = obj.position + 0.5f * (obj.mesh.boundsMax + obj.mesh.boundsMin) * obj.scale;
+        lo = glm::min(lo, mid - halfSize);
+        hi = glm::max(hi, mid + halfSize);
+    }
+    if (map.objects.empty()) {
+        lo = hi = glm::vec3(0.0f);
+    }
+    center = 0.5f * (lo + hi);
+    radius = std::max(0.5f * glm::length(hi - lo), 1.0f);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5)];
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+bool WantsRenderBenchmark(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+            return true;
+    }
+    return false;
+}
+
+void PrintRenderBenchmarkUsage() {
+    std::cout << "Usage: 3DLevED --benchmark [options]\n"
+                 "  --map <file>        Render a saved map (.txt text, otherwise binary)\n"
+                 "  --scene maze|voxel  Generate a scene instead (default maze)\n"
+                 "  --seed <n>          Seed for the generated scene (default 1)\n"
+                 "  --size <n>          Maze cells or voxel columns per side (default 48)\n"
+                 "  --shader <base>     Shader pair for maze walls (default basic_lit)\n"
+                 "  --frames <n>        Frames to measure (default 600)\n"
+                 "  --resolution <WxH>  Framebuffer size (default 1280x720)\n"
+                 "  --output <file>     JSON results (default benchmark.json)\n";
+}
+
+bool ParseRenderBenchmarkArgs(int argc, char** argv, RenderBenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--benchmark")
+            continue;
+        if (arg == "--help") {
+            PrintRenderBenchmarkUsage();
+            return false;
+        }
+        static const char* const valued[] = { "--map", "--scene", "--shader", "--output", "--seed", "--size",
+                                              "--frames", "--resolution" };
+        if (std::none_of(std::begin(valued), std::end(valued), [&](const char* name) { return arg == name; })) {
+            std::cerr << "Benchmark: unknown option " << arg << std::endl;
+            PrintRenderBenchmarkUsage();
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Benchmark: missing value for " << arg << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--map") options.mapPath = value;
+        else if (arg == "--scene") options.scene = value;
+        else if (arg == "--shader") options.shaderBase = value;
+        else if (arg == "--output") options.outputPath = value;
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--size") valid = (options.size = std::atoi(value.c_str())) > 0;
+        else if (arg == "--frames") valid = (options.frames = std::atoi(value.c_str())) > 0;
+        else if (arg == "--resolution")
+            valid = std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) == 2
+                 && options.width > 0 && options.height > 0;
+        if (!valid) {
+            std::cerr << "Benchmark: bad value '" << value << "' for " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int RunRenderBenchmark(const RenderBenchmarkOptions& options) {
+    // An invisible window is enough for a context; under Xvfb this runs on Mesa's llvmpipe
+    if (!glfwInit()) {
+        std::cerr << "Benchmark: failed to initialize GLFW (no display? try xvfb-run)" << std::endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    GLFWwindow* window = glfwCreateWindow(options.width, options.height, "3DLevED benchmark", NULL, NULL);
+    if (!window) {
+        std::cerr << "Benchmark: failed to create an OpenGL 3.3 context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);  // Measure rendering, not the display's refresh rate
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Benchmark: failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glEnable(GL_DEPTH_TEST);
+    shaders = listShaderFiles(currentShaderPath);
+
+    int exitCode = 1;
+    {
+        Map map;
+        VoxelMap vmap;
+        const bool voxelScene = options.mapPath.empty() && options.scene == "voxel";
+        if (buildScene(options, map, vmap)) {
+            glm::vec3 center;
+            float radius;
+            sceneBounds(map, center, radius);
+            const float orbitDistance = std::min(radius * 1.6f, 80.0f);  // Inside the 100-unit far plane
+            camera.setTarget(center);
+
+            // The window may come out smaller than asked for; render at what we got
+            int fbWidth, fbHeight;
+            glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+
+            auto renderFrame = [&](float t) {
+                camera.setOrbit(360.0f * t, -30.0f + 12.0f * std::sin(6.2831853f * t), orbitDistance);
+                glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), (float)fbWidth / (float)fbHeight, 0.1f, 100.0f)
+                                         * camera.getViewMatrix();
+                glViewport(0, 0, fbWidth, fbHeight);
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                GpuProfiler::BeginPass(GpuProfiler::PASS_GRID);
+                camera.renderGrid(viewProjection);
+                GpuProfiler::EndPass(GpuProfiler::PASS_GRID);
+                UpdateShaderCompiles();
+                if (voxelScene)
+                    UpdateVoxelObjects(vmap, map);
+                GpuProfiler::BeginPass(GpuProfiler::PASS_MAP);
+                map.render(camera, fbWidth, fbHeight);
+                GpuProfiler::EndPass(GpuProfiler::PASS_MAP);
+                GpuProfiler::EndFrame();
+
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            };
+
+            // Until every program has linked and every chunk is meshed, frames measure the fallbacks
+            auto settleStart = std::chrono::steady_clock::now();
+            int settleFrames = 0;
+            while ((PendingShaderCompiles() > 0 || PendingVoxelChunkJobs() > 0 || vmap.hasDirtyChunks())
+                   && std::chrono::duration<double>(std::chrono::steady_clock::now() - settleStart).count() < SETTLE_TIMEOUT) {
+                renderFrame(0.0f);
+                ++settleFrames;
+            }
+            if (PendingShaderCompiles() > 0 || PendingVoxelChunkJobs() > 0)
+                std::cerr << "Benchmark: scene still loading after " << SETTLE_TIMEOUT << " s, measuring anyway" << std::endl;
+            for (int i = 0; i < WARMUP_FRAMES; ++i)
+                renderFrame(0.0f);
+
+            // glFinish closes every frame, so a frame's time covers its GPU work as well
+            std::vector<double> frameMs;
+            frameMs.reserve(options.frames);
+            FrameTotals totals;
+            for (int frame = 0; frame < options.frames; ++frame) {
+                auto start = std::chrono::steady_clock::now();
+                renderFrame(static_cast<float>(frame) / options.frames);
+                glFinish();
+                frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+                for (int pass = 0; pass < GpuProfiler::PASS_COUNT; ++pass) {
+                    GpuProfiler::PassStats stats = GpuProfiler::GetPassStats(pass);
+                    totals.drawCalls += stats.drawCalls;
+                    totals.triangles += static_cast<double>(stats.triangles);
+                    totals.stateChanges += stats.stateChanges;
+                }
+            }
+
+            std::vector<double> sorted = frameMs;
+            std::sort(sorted.begin(), sorted.end());
+            double totalMs = 0.0;
+            for (double ms : frameMs)
+                totalMs += ms;
+            size_t meshBytes = 0;
+            for (const auto& obj : map.objects)
+                meshBytes += obj.mesh.byteSize();
+            long long residentKB, peakKB;
+            readProcessMemory(residentKB, peakKB);
+            GpuProfiler::PassStats gpuMap = GpuProfiler::GetPassStats(GpuProfiler::PASS_MAP);
+            const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+            const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+            std::ofstream out(options.outputPath);
+            if (!out) {
+                std::cerr << "Benchmark: failed to open " << options.outputPath << " for writing" << std::endl;
+            } else {
+                const double frames = static_cast<double>(options.frames);
+                out << "{\n  \"scene\": ";
+                writeJsonString(out, options.mapPath.empty() ? options.scene : options.mapPath);
+                out << ",\n  \"seed\": " << options.seed << ",\n  \"size\": " << options.size
+                    << ",\n  \"renderer\": ";
+                writeJsonString(out, renderer ? renderer : "");
+                out << ",\n  \"gl_version\": ";
+                writeJsonString(out, version ? version : "");
+                out << ",\n  \"width\": " << fbWidth << ",\n  \"height\": " << fbHeight
+                    << ",\n  \"objects\": " << map.objects.size()
+                    << ",\n  \"settle_frames\": " << settleFrames
+                    << ",\n  \"frames\": " << options.frames
+                    << ",\n  \"frame_ms\": { \"mean\": " << totalMs / frames
+                    << ", \"p50\": " << percentile(sorted, 0.50) << ", \"p90\": " << percentile(sorted, 0.90)
+                    << ", \"p95\": " << percentile(sorted, 0.95) << ", \"p99\": " << percentile(sorted, 0.99)
+                    << ", \"max\": " << sorted.back() << " }"
+                    << ",\n  \"gpu_map_ms\": { \"mean\": " << gpuMap.averageMs << ", \"p50\": " << gpuMap.p50Ms
+                    << ", \"p95\": " << gpuMap.p95Ms << ", \"p99\": " << gpuMap.p99Ms << " }"
+                    << ",\n  \"per_frame\": { \"draw_calls\": " << totals.drawCalls / frames
+                    << ", \"triangles\": " << totals.triangles / frames
+                    << ", \"state_changes\": " << totals.stateChanges / frames << " }"
+                    << ",\n  \"memory\": { \"mesh_bytes\": " << meshBytes
+                    << ", \"resident_kb\": " << residentKB << ", \"peak_resident_kb\": " << peakKB << " }\n}\n";
+                std::cout << "Benchmark: " << options.frames << " frames, p50 " << percentile(sorted, 0.50)
+                          << " ms, p99 " << percentile(sorted, 0.99) << " ms -> " << options.outputPath << std::endl;
+                exitCode = out ? 0 : 1;
+            }
+        }
+    }
+
+    GpuProfiler::Shutdown();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return exitCode;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Headless rendering benchmark: renders a scene from a fixed camera path in an invisible window
+// and writes frame-time percentiles, draw counts and memory use as JSON, so runs can be compared
+// automatically. Started with "3DLevED --benchmark [options]"; see PrintRenderBenchmarkUsage.
+struct RenderBenchmarkOptions {
+    std::string mapPath;            // Loaded when set (.txt as text, anything else binary)
+    std::string scene = "maze";     // Otherwise generated: "maze" or "voxel"
+    std::string shaderBase = "basic_lit";
+    uint32_t seed = 1;
+    int size = 48;                  // Maze cells or voxel columns per side
+    int frames = 600;               // Measured frames, after the warm-up
+    int width = 1280, height = 720;
+    std::string outputPath = "benchmark.json";
+};
+
+bool WantsRenderBenchmark(int argc, char** argv);  // "--benchmark" anywhere on the command line
+// Reads the options after the program name; false, with a message on std::cerr, on a bad one
+bool ParseRenderBenchmarkArgs(int argc, char** argv, RenderBenchmarkOptions& options);
+void PrintRenderBenchmarkUsage();
+// Owns GLFW for the whole run; returns the process exit code
+int RunRenderBenchmark(const RenderBenchmarkOptions& options);
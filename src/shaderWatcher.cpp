@@ -0,0 +1,146 @@
+#include "shaderWatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::thread watcherThread;
+std::atomic<bool> stopping{ false };
+const char* mode = "off";
+
+std::mutex changedMutex;
+std::set<std::string> changedFiles;
+
+void markChanged(const std::string& name) {
+    std::lock_guard<std::mutex> lock(changedMutex);
+    changedFiles.insert(name);
+}
+
+bool isShaderFile(const std::filesystem::path& path) {
+    const auto ext = path.extension();
+    return ext == ".vert" || ext == ".frag" || ext == ".glsl";
+}
+
+void pollLoop(std::filesystem::path directory) {
+    std::unordered_map<std::string, std::filesystem::file_time_type> lastWrite;
+    bool first = true;
+    while (!stopping) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+            if (!entry.is_regular_file(ec) || !isShaderFile(entry.path()))
+                continue;
+            const auto time = entry.last_write_time(ec);
+            if (ec)
+                continue;
+            const std::string name = std::filesystem::relative(entry.path(), directory, ec).generic_string();
+            auto it = lastWrite.find(name);
+            if (it == lastWrite.end()) {
+                lastWrite[name] = time;
+                if (!first)
+                    markChanged(name);
+            } else if (it->second != time) {
+                it->second = time;
+                markChanged(name);
+            }
+        }
+        first = false;
+        for (int i = 0; i < 5 && !stopping; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+#if defined(__linux__)
+// Close-after-write catches in-place saves, moved-to catches editors that save by renaming
+// a temporary file over the original
+void inotifyLoop(int fd, std::filesystem::path directory) {
+    std::unordered_map<int, std::string> watchPrefix;  // Watch descriptor -> subdirectory ("" or "include/")
+    const uint32_t events = IN_CLOSE_WRITE | IN_MOVED_TO;
+    watchPrefix[inotify_add_watch(fd, directory.c_str(), events)] = "";
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+        if (entry.is_directory(ec)) {
+            const int wd = inotify_add_watch(fd, entry.path().c_str(), events);
+            if (wd >= 0)
+                watchPrefix[wd] = std::filesystem::relative(entry.path(), directory, ec).generic_string() + "/";
+        }
+    }
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    pollfd pfd{ fd, POLLIN, 0 };
+    while (!stopping) {
+        if (poll(&pfd, 1, 200) <= 0)
+            continue;
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && isShaderFile(event->name)) {
+                auto prefix = watchPrefix.find(event->wd);
+                markChanged((prefix != watchPrefix.end() ? prefix->second : std::string()) + event->name);
+            }
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+    close(fd);
+}
+#endif
+
+} // namespace
+
+bool StartShaderWatcher(const std::filesystem::path& directory) {
+    StopShaderWatcher();
+    if (!std::filesystem::is_directory(directory)) {
+        std::cerr << "Shader watcher: " << directory << " is not a directory" << std::endl;
+        return false;
+    }
+    stopping = false;
+
+#if defined(__linux__)
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0) {
+        mode = "inotify";
+        watcherThread = std::thread(inotifyLoop, fd, directory);
+        std::cout << "Shader watcher: watching " << directory << " with inotify" << std::endl;
+        return true;
+    }
+    std::cerr << "Shader watcher: inotify unavailable, polling instead" << std::endl;
+#endif
+    mode = "polling";
+    watcherThread = std::thread(pollLoop, directory);
+    std::cout << "Shader watcher: polling " << directory << std::endl;
+    return true;
+}
+
+void StopShaderWatcher() {
+    if (!watcherThread.joinable())
+        return;
+    stopping = true;
+    watcherThread.join();
+    mode = "off";
+}
+
+bool ShaderWatcherRunning() {
+    return watcherThread.joinable();
+}
+
+const char* ShaderWatcherMode() {
+    return mode;
+}
+
+std::vector<std::string> TakeChangedShaderFiles() {
+    std::lock_guard<std::mutex> lock(changedMutex);
+    std::vector<std::string> files(changedFiles.begin(), changedFiles.end());
+    changedFiles.clear();
+    return files;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Watches the shader directory on a background thread and collects the names of files that
+// were written. Uses inotify on Linux and falls back to polling modification times elsewhere,
+// or when inotify is unavailable.
+bool StartShaderWatcher(const std::filesystem::path& directory);
+void StopShaderWatcher();
+bool ShaderWatcherRunning();
+const char* ShaderWatcherMode();  // "inotify", "polling" or "off"
+
+// File names (no directory) changed since the last call, each listed once
+std::vector<std::string> TakeChangedShaderFiles();
@@ -10,6 +10,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <map>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <GLFW/glfw3.h>
+#include "shaderWatcher.h"
+#include "cpuProfiler.h"
 
 GLuint shaderProgram = 0;
 std::unordered_map<std::string, GLuint> shaderCache;  // Cache to store loaded shaders
@@ -67,66 +73,614 @@ std::string loadShaderSource(const std::string& filename) {
     return buffer.str();
 }
 
-GLuint compileShader(GLenum shaderType, const std::string& source) {
+const char* ShaderFeatureName(uint32_t feature) {
+    switch (feature) {
+    case SHADER_NO_MODEL: return "NO_MODEL";
+    default:              return nullptr;
+    }
+}
+
+// Expands #include "file" in place, each file once, with #line directives so compiler errors
+// still point at the right line. Source string numbers in errors index dependencies.
+static void expandIncludes(const std::string& fileName, uint32_t features, std::vector<std::string>& included,
+                           std::ostringstream& out) {
+    const int fileIndex = static_cast<int>(included.size());
+    included.push_back(fileName);
+
+    std::istringstream in(loadShaderSource(fileName));
+    std::string line;
+    if (fileIndex > 0)
+        out << "#line 1 " << fileIndex << "\n";
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+        const size_t start = line.find_first_not_of(" \t");
+        const std::string directive = start == std::string::npos ? "" : line.substr(start);
+
+        if (directive.rfind("#include", 0) == 0) {
+            const size_t open = directive.find('"'), close = directive.rfind('"');
+            if (open == std::string::npos || close <= open) {
+                std::cerr << fileName << "(" << lineNumber << "): malformed #include" << std::endl;
+                continue;
+            }
+            const std::string target = directive.substr(open + 1, close - open - 1);
+            if (std::find(included.begin(), included.end(), target) == included.end()) {
+                expandIncludes(target, features, included, out);
+                out << "#line " << lineNumber + 1 << " " << fileIndex << "\n";
+            }
+            continue;
+        }
+
+        out << line << "\n";
+        // Defines go straight after #version, which must stay the first statement
+        if (directive.rfind("#version", 0) == 0) {
+            for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+                if ((features & bit) && ShaderFeatureName(bit))
+                    out << "#define " << ShaderFeatureName(bit) << " 1\n";
+            }
+            out << "#line " << lineNumber + 1 << " " << fileIndex << "\n";
+        }
+    }
+}
+
+std::string PreprocessShaderSource(const std::string& fileName, uint32_t features, std::vector<std::string>* dependencies) {
+    std::vector<std::string> included;
+    std::ostringstream out;
+    expandIncludes(fileName, features, included, out);
+    if (dependencies)
+        dependencies->insert(dependencies->end(), included.begin(), included.end());
+    return out.str();
+}
+
+// Compiles without waiting; with KHR_parallel_shader_compile the driver finishes it on its own threads
+static GLuint startCompile(GLenum shaderType, const std::string& source) {
     GLuint shader = glCreateShader(shaderType);
     const char* shaderSource = source.c_str();
     glShaderSource(shader, 1, &shaderSource, nullptr);
     glCompileShader(shader);
+    return shader;
+}
 
+// Blocks until the shader is compiled, logging errors
+static bool checkCompile(GLuint shader, const std::string& name) {
     GLint success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
         GLint logLength;
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-        char* log = new char[logLength];
-        glGetShaderInfoLog(shader, logLength, nullptr, log);
-        std::cerr << "Error compiling shader: " << log << std::endl;
-        delete[] log;
+        std::vector<char> log(std::max(logLength, 1), '\0');
+        glGetShaderInfoLog(shader, logLength, nullptr, log.data());
+        std::cerr << "Error compiling shader " << name << ": " << log.data() << std::endl;
     }
+    return success == GL_TRUE;
+}
 
+GLuint compileShader(GLenum shaderType, const std::string& source) {
+    GLuint shader = startCompile(shaderType, source);
+    checkCompile(shader, shaderType == GL_VERTEX_SHADER ? "(vertex)" : "(fragment)");
     return shader;
 }
 
+// Program binaries are keyed by both sources and the driver, since a binary is only valid for
+// the exact driver that produced it
+std::filesystem::path shaderBinaryCachePath = "shader_cache";
+static ShaderCacheStats cacheStats;
+
+const ShaderCacheStats& GetShaderCacheStats() {
+    return cacheStats;
+}
+
+static bool programBinariesSupported() {
+    static int supported = -1;
+    if (supported < 0) {
+        GLint formats = 0;
+        if (glProgramBinary && glGetProgramBinary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0 ? 1 : 0;
+        if (!supported)
+            std::cout << "Shader binary cache: driver exposes no program binary formats, compiling from source" << std::endl;
+    }
+    return supported == 1;
+}
 
+static uint64_t programCacheKey(const std::string& vertexSource, const std::string& fragmentSource) {
+    // FNV-1a over the sources and the driver identity, with a separator between fields
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const char* text) {
+        for (const char* c = text ? text : ""; *c; ++c) {
+            hash ^= static_cast<unsigned char>(*c);
+            hash *= 1099511628211ull;
+        }
+        hash ^= 0xFF;
+        hash *= 1099511628211ull;
+    };
+    mix(vertexSource.c_str());
+    mix(fragmentSource.c_str());
+    mix(reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    mix(reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    mix(reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return hash;
+}
 
+static std::filesystem::path programCacheFile(uint64_t key) {
+    std::ostringstream name;
+    name << std::hex << key << ".bin";
+    return shaderBinaryCachePath / name.str();
+}
 
+static const uint32_t PROGRAM_CACHE_MAGIC = 0x424C4433;  // "3DLB"
+
+// Returns 0 when there is no usable binary; a rejected binary (new driver, corrupt file) is deleted
+static GLuint loadProgramBinary(uint64_t key) {
+    const std::filesystem::path path = programCacheFile(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return 0;
+
+    auto reject = [&path]() -> GLuint {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        ++cacheStats.rejected;
+        return 0;
+    };
+
+    // Check the header before trusting length, so a truncated file can't ask for gigabytes
+    uint32_t magic = 0, length = 0;
+    GLenum format = 0;
+    const uintmax_t headerSize = sizeof(magic) + sizeof(format) + sizeof(length);
+    std::error_code sizeError;
+    const uintmax_t fileSize = std::filesystem::file_size(path, sizeError);
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&format), sizeof(format));
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!in.good() || sizeError || magic != PROGRAM_CACHE_MAGIC || length == 0 || fileSize < headerSize ||
+        length > fileSize - headerSize) {
+        in.close();
+        return reject();
+    }
+    std::vector<char> binary(length);
+    in.read(binary.data(), length);
+    const bool readOk = in.good();
+    in.close();
+    if (!readOk)
+        return reject();
+
+    GLint linked = GL_FALSE;
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        glDeleteProgram(program);
+        return reject();
+    }
+    return program;
+}
 
-GLuint createShaderProgramFromFile(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
+static void saveProgramBinary(uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(shaderBinaryCachePath, ec);
+    std::ofstream out(programCacheFile(key), std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Shader binary cache: could not write " << programCacheFile(key).string() << std::endl;
+        return;
+    }
+    const uint32_t size = static_cast<uint32_t>(length);
+    out.write(reinterpret_cast<const char*>(&PROGRAM_CACHE_MAGIC), sizeof(PROGRAM_CACHE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(binary.data(), length);
+}
+
+static GLuint startLink(GLuint vertexShader, GLuint fragmentShader, bool retrievable) {
+    GLuint program = glCreateProgram();
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    return program;
+}
+
+// Blocks until linking is done. Returns false and logs the info log when it failed.
+static bool checkLink(GLuint program, const std::string& name) {
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLint logLength = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(std::max(logLength, 1), '\0');
+        glGetProgramInfoLog(program, logLength, nullptr, log.data());
+        std::cerr << "Error linking shader program " << name << ": " << log.data() << std::endl;
+    }
+    return success == GL_TRUE;
+}
+
+// Where every program in shaderCache came from, for finding what a changed file affects
+struct ProgramSource {
+    std::string vertex, fragment;
+    uint32_t features = 0;
+    std::vector<std::string> dependencies;  // Both files and everything they include
+    ShaderLod lod;
+};
+static std::unordered_map<std::string, ProgramSource> programFiles;
+
+// The first "// lod: <vertex> <fragment> <pixels>" line of a fragment shader
+static ShaderLod parseShaderLod(const std::string& fragmentSource) {
+    std::istringstream lines(fragmentSource);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 7, "// lod:") != 0)
+            continue;
+
+        ShaderLod lod;
+        std::istringstream fields(line.substr(start + 7));
+        if (!(fields >> lod.vertexShader >> lod.fragmentShader >> lod.minPixels) || lod.minPixels <= 0.0f) {
+            std::cerr << "Ignoring malformed LOD line: " << line << std::endl;
+            return {};
+        }
+        return lod;
+    }
+    return {};
+}
+
+// Preprocesses both stages and records the files they were built from
+static void readProgramSources(ProgramSource& source, std::string& vertexSource, std::string& fragmentSource) {
+    source.dependencies.clear();
+    vertexSource = PreprocessShaderSource(source.vertex, source.features, &source.dependencies);
+    fragmentSource = PreprocessShaderSource(source.fragment, source.features, &source.dependencies);
+    source.lod = parseShaderLod(fragmentSource);
+}
+
+static std::string programKey(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, uint32_t features) {
     std::string key = vertexShaderPath + "+" + fragmentShaderPath;
-    if (shaderCache.count(key)) {
-        return shaderCache[key];  // Return cached program
+    if (features != 0)
+        key += "#" + std::to_string(features);  // Each permutation is its own program
+    return key;
+}
+
+// Puts program in the cache, deleting the one it replaces
+static void swapProgram(const std::string& key, GLuint program) {
+    GLuint& slot = shaderCache[key];
+    if (slot != 0 && slot != program)
+        glDeleteProgram(slot);
+    slot = program;
+}
+
+// Records a linked (or failed, program 0) pair in the caches. A failed reload keeps the last good program.
+static GLuint finishProgram(const std::string& key, GLuint program, bool useBinaries, uint64_t binaryKey,
+                            bool replacing = false) {
+    if (program != 0) {
+        ++cacheStats.compiled;
+        if (useBinaries)
+            saveProgramBinary(binaryKey, program);
+    } else {
+        ++cacheStats.failed;
+    }
+    if (replacing) {
+        if (program != 0)
+            swapProgram(key, program);
+        std::cout << "Hot reload: " << key << (program != 0 ? " updated" : " failed, keeping the last good program")
+                  << std::endl;
+        return shaderCache[key];
     }
+    shaderCache[key] = program;  // A failed pair stays 0 rather than recompiling every frame
+    return program;
+}
 
-    std::string vertexShaderSource = loadShaderSource(vertexShaderPath);
-    std::string fragmentShaderSource = loadShaderSource(fragmentShaderPath);
+// --- Asynchronous compilation ---
 
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+namespace {
+
+struct PendingProgram {
+    enum class Stage { Queued, CompilingVertex, CompilingFragment, Linking };
+
+    std::string key;
+    std::string vertexSource, fragmentSource;
+    Stage stage = Stage::Queued;
+    bool replacing = false;  // Hot reload of a program that is already in the cache
+    GLuint vertexShader = 0, fragmentShader = 0, program = 0;
+    uint64_t binaryKey = 0;
+};
+
+std::vector<PendingProgram> pendingPrograms;
+GLuint fallbackProgram = 0;
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
 
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+bool parallelCompileSupported() {
+    static int supported = -1;
+    if (supported < 0) {
+        supported = hasExtension("GL_KHR_parallel_shader_compile") || hasExtension("GL_ARB_parallel_shader_compile");
+        if (supported) {
+            // Let the driver pick the thread count; the ARB entry point has the same signature
+            auto setThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+            if (!setThreads)
+                setThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+            if (setThreads)
+                setThreads(0xFFFFFFFFu);
+        }
+        std::cout << "Shader compilation: " << (supported ? "parallel (KHR_parallel_shader_compile)" : "spread across frames")
+                  << std::endl;
+    }
+    return supported == 1;
+}
+
+bool completed(GLuint object, bool isProgram) {
+    GLint done = GL_FALSE;
+    if (isProgram)
+        glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &done);
+    else
+        glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+// Moves one pending program forward. Without the extension every stage is a blocking GL call,
+// so each call does one of them; with it, calls only poll and return true when the program is done.
+bool advance(PendingProgram& pending, bool parallel) {
+    const bool useBinaries = programBinariesSupported();
+    switch (pending.stage) {
+    case PendingProgram::Stage::Queued:
+        pending.vertexShader = startCompile(GL_VERTEX_SHADER, pending.vertexSource);
+        if (parallel)
+            pending.fragmentShader = startCompile(GL_FRAGMENT_SHADER, pending.fragmentSource);
+        pending.stage = PendingProgram::Stage::CompilingVertex;
+        return false;
+    case PendingProgram::Stage::CompilingVertex:
+        if (parallel) {
+            if (!completed(pending.vertexShader, false) || !completed(pending.fragmentShader, false))
+                return false;
+        } else {
+            pending.fragmentShader = startCompile(GL_FRAGMENT_SHADER, pending.fragmentSource);
+        }
+        pending.stage = PendingProgram::Stage::CompilingFragment;
+        return false;
+    case PendingProgram::Stage::CompilingFragment:
+        if (!checkCompile(pending.vertexShader, pending.key) || !checkCompile(pending.fragmentShader, pending.key)) {
+            finishProgram(pending.key, 0, useBinaries, pending.binaryKey, pending.replacing);
+            return true;
+        }
+        pending.program = startLink(pending.vertexShader, pending.fragmentShader, useBinaries);
+        pending.stage = PendingProgram::Stage::Linking;
+        return false;
+    case PendingProgram::Stage::Linking:
+        if (parallel && !completed(pending.program, true))
+            return false;
+        if (!checkLink(pending.program, pending.key)) {
+            glDeleteProgram(pending.program);
+            pending.program = 0;
+        }
+        finishProgram(pending.key, pending.program, useBinaries, pending.binaryKey, pending.replacing);
+        return true;
+    }
+    return true;
+}
+
+void releaseShaders(PendingProgram& pending) {
+    if (pending.vertexShader) glDeleteShader(pending.vertexShader);
+    if (pending.fragmentShader) glDeleteShader(pending.fragmentShader);
+    pending.vertexShader = pending.fragmentShader = 0;
+}
+
+// Flat grey, drawn while an object's own program is still compiling
+const char* FALLBACK_VERTEX_SOURCE = R"(#version 330 core
+layout(location = 0) in vec3 aPos;
+uniform mat4 MVP;
+void main() { gl_Position = MVP * vec4(aPos, 1.0); }
+)";
+const char* FALLBACK_FRAGMENT_SOURCE = R"(#version 330 core
+out vec4 FragColor;
+void main() { FragColor = vec4(0.45, 0.45, 0.5, 1.0); }
+)";
+
+} // namespace
+
+GLuint GetFallbackShaderProgram() {
+    if (fallbackProgram == 0) {
+        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, FALLBACK_VERTEX_SOURCE);
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, FALLBACK_FRAGMENT_SOURCE);
+        fallbackProgram = startLink(vertexShader, fragmentShader, false);
+        checkLink(fallbackProgram, "fallback");
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+    return fallbackProgram;
+}
+
+void UpdateShaderCompiles() {
+    PROFILE_ZONE("Shader Compiles");
+    const std::vector<std::string> changed = TakeChangedShaderFiles();
+    if (!changed.empty())
+        ReloadShadersUsing(changed);
+    if (pendingPrograms.empty())
+        return;
+
+    const bool parallel = parallelCompileSupported();
+    // Without the extension, blocking steps run until this much of the frame is used (at least one)
+    const double budgetMs = 2.0;
+    auto start = std::chrono::steady_clock::now();
+    auto overBudget = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs;
+    };
+    for (size_t i = 0; i < pendingPrograms.size();) {
+        PendingProgram& pending = pendingPrograms[i];
+        bool done = advance(pending, parallel);
+        while (!parallel && !done && !overBudget())
+            done = advance(pending, parallel);
+
+        if (done) {
+            releaseShaders(pending);
+            pendingPrograms.erase(pendingPrograms.begin() + i);
+        } else if (parallel) {
+            ++i;  // Every program compiles at once on the driver's threads
+        }
+        if (!parallel && overBudget())
+            break;
+    }
+}
 
-    // error check omitted for brevity
+int PendingShaderCompiles() {
+    return static_cast<int>(pendingPrograms.size());
+}
 
+// Drops a queued compile of key so a blocking compile can replace it
+static void cancelPending(const std::string& key) {
+    for (size_t i = 0; i < pendingPrograms.size(); ++i) {
+        if (pendingPrograms[i].key == key) {
+            releaseShaders(pendingPrograms[i]);
+            if (pendingPrograms[i].program)
+                glDeleteProgram(pendingPrograms[i].program);
+            pendingPrograms.erase(pendingPrograms.begin() + i);
+            return;
+        }
+    }
+}
+
+GLuint createShaderProgramVariant(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+                                 uint32_t features) {
+    PROFILE_ZONE("Compile Shader Program");
+    std::string key = programKey(vertexShaderPath, fragmentShaderPath, features);
+    if (shaderCache.count(key)) {
+        return shaderCache[key];  // Return cached program
+    }
+    cancelPending(key);
+
+    ProgramSource& source = programFiles[key];
+    source = { vertexShaderPath, fragmentShaderPath, features, {} };
+    std::string vertexShaderSource, fragmentShaderSource;
+    readProgramSources(source, vertexShaderSource, fragmentShaderSource);
+
+    const bool useBinaries = programBinariesSupported();
+    const uint64_t binaryKey = useBinaries ? programCacheKey(vertexShaderSource, fragmentShaderSource) : 0;
+    GLuint shaderProgram = useBinaries ? loadProgramBinary(binaryKey) : 0;
+    if (shaderProgram != 0) {
+        ++cacheStats.fromCache;
+        std::cout << "Shader program " << key << " loaded from binary cache" << std::endl;
+        shaderCache[key] = shaderProgram;
+        return shaderProgram;
+    }
+
+    GLuint vertexShader = startCompile(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fragmentShader = startCompile(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    if (checkCompile(vertexShader, vertexShaderPath) && checkCompile(fragmentShader, fragmentShaderPath)) {
+        shaderProgram = startLink(vertexShader, fragmentShader, useBinaries);
+        if (!checkLink(shaderProgram, key)) {
+            glDeleteProgram(shaderProgram);
+            shaderProgram = 0;
+        }
+    }
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    return finishProgram(key, shaderProgram, useBinaries, binaryKey);
+}
 
-    shaderCache[key] = shaderProgram;  // Cache it
-    return shaderProgram;
+GLuint createShaderProgramFromFile(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
+    return createShaderProgramVariant(vertexShaderPath, fragmentShaderPath, 0);
 }
 
-GLuint loadShader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
-    std::string key = vertexShaderPath + "+" + fragmentShaderPath;
+GLuint loadShaderVariant(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, uint32_t features) {
+    std::string key = programKey(vertexShaderPath, fragmentShaderPath, features);
 
-    if (shaderCache.find(key) != shaderCache.end()) {
-        return shaderCache[key];
+    auto cached = shaderCache.find(key);
+    if (cached != shaderCache.end()) {
+        return cached->second;
+    }
+    for (const PendingProgram& pending : pendingPrograms) {
+        if (pending.key == key)
+            return GetFallbackShaderProgram();
     }
 
-    GLuint shaderProgram = createShaderProgramFromFile(vertexShaderPath, fragmentShaderPath);
-    shaderCache[key] = shaderProgram;
-    return shaderProgram;
+    // A cached binary is cheap enough to load right away; anything else compiles in the background
+    ProgramSource& source = programFiles[key];
+    source = { vertexShaderPath, fragmentShaderPath, features, {} };
+    PendingProgram pending;
+    pending.key = key;
+    readProgramSources(source, pending.vertexSource, pending.fragmentSource);
+    if (programBinariesSupported()) {
+        pending.binaryKey = programCacheKey(pending.vertexSource, pending.fragmentSource);
+        GLuint program = loadProgramBinary(pending.binaryKey);
+        if (program != 0) {
+            ++cacheStats.fromCache;
+            shaderCache[key] = program;
+            return program;
+        }
+    }
+    pendingPrograms.push_back(std::move(pending));
+    return GetFallbackShaderProgram();
+}
+
+GLuint loadShader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
+    return loadShaderVariant(vertexShaderPath, fragmentShaderPath, 0);
+}
+
+const ShaderLod* GetShaderLod(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+                              uint32_t features) {
+    auto it = programFiles.find(programKey(vertexShaderPath, fragmentShaderPath, features));
+    if (it == programFiles.end() || it->second.lod.minPixels <= 0.0f)
+        return nullptr;
+    return &it->second.lod;
+}
+
+int ReloadShadersUsing(const std::vector<std::string>& fileNames) {
+    PROFILE_ZONE("Reload Shaders");
+    auto uses = [&](const std::string& file) {
+        const std::filesystem::path name = std::filesystem::path(file).filename();
+        for (const std::string& changed : fileNames) {
+            if (std::filesystem::path(changed).filename() == name)
+                return true;
+        }
+        return false;
+    };
+
+    int queued = 0;
+    for (auto& [key, source] : programFiles) {
+        if (std::none_of(source.dependencies.begin(), source.dependencies.end(), uses))
+            continue;
+
+        // A reload already under way started from sources that are now stale
+        cancelPending(key);
+        PendingProgram pending;
+        pending.key = key;
+        pending.replacing = shaderCache.count(key) != 0;
+        readProgramSources(source, pending.vertexSource, pending.fragmentSource);  // Includes may have changed too
+        if (programBinariesSupported()) {
+            pending.binaryKey = programCacheKey(pending.vertexSource, pending.fragmentSource);
+            GLuint program = loadProgramBinary(pending.binaryKey);
+            if (program != 0) {
+                ++cacheStats.fromCache;
+                swapProgram(key, program);
+                ++queued;
+                continue;
+            }
+        }
+        pendingPrograms.push_back(std::move(pending));
+        ++queued;
+    }
+    std::cout << "Hot reload: ";
+    for (const std::string& file : fileNames)
+        std::cout << file << " ";
+    std::cout << "-> " << queued << " program(s)" << std::endl;
+    return queued;
 }
 
 
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <filesystem>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -19,8 +21,55 @@ extern std::vector<char> shaderBuffer;
 std::vector<std::filesystem::path> listShaderFiles(const std::filesystem::path& dir);
 bool saveShaderSource(const std::filesystem::path& filePath, const std::string& content);
 
+// Non-blocking: a pair seen for the first time is queued for compilation and the fallback
+// program is returned until it has linked. createShaderProgramFromFile compiles on the spot.
 GLuint loadShader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
+
+// Compile-time permutations: each set bit becomes a #define after #version, and every
+// combination is compiled once and cached as its own program
+enum ShaderFeature : uint32_t {
+    SHADER_NO_MODEL = 1u << 0,  // Vertices already in world space: no model uniform or normal matrix
+};
+const char* ShaderFeatureName(uint32_t feature);  // The #define for one bit, or null
+
+// Loads a shader file with #include "file" expanded (paths relative to the shader directory,
+// each file included once) and the feature defines inserted. Appends every file read to dependencies.
+std::string PreprocessShaderSource(const std::string& fileName, uint32_t features,
+                                   std::vector<std::string>* dependencies = nullptr);
+GLuint loadShaderVariant(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, uint32_t features);
+GLuint createShaderProgramVariant(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+                                  uint32_t features);
+GLuint GetFallbackShaderProgram();
+
+// A cheaper pair a material switches to when it covers few pixels. The fragment shader declares
+// it with a comment line "// lod: <vertex> <fragment> <pixels>".
+struct ShaderLod {
+    std::string vertexShader, fragmentShader;
+    float minPixels = 0.0f;  // Projected radius, in pixels, below which the cheaper pair is used
+};
+// The LOD of a pair already passed to loadShader, or null when it declares none
+const ShaderLod* GetShaderLod(const std::string& vertexShaderPath, const std::string& fragmentShaderPath,
+                              uint32_t features = 0);
+// Advances queued compiles; call once per frame. Uses KHR_parallel_shader_compile when the
+// driver has it, otherwise does blocking compile/link steps within a small per-frame budget.
+void UpdateShaderCompiles();
+int PendingShaderCompiles();
+// Recompiles, in the background, every cached program built from one of these files and swaps
+// each in once it links; a program that fails keeps its last good version. Returns the count.
+// UpdateShaderCompiles calls this with the files the shader watcher (shaderWatcher.h) reports.
+int ReloadShadersUsing(const std::vector<std::string>& fileNames);
 GLuint createShaderProgramFromFile(const std::string& vertFile, const std::string& fragFile);
+
+// Linked programs are saved under shaderBinaryCachePath with glGetProgramBinary and reloaded on
+// later runs when the sources and the driver are unchanged
+extern std::filesystem::path shaderBinaryCachePath;
+struct ShaderCacheStats {
+    int fromCache = 0;  // Programs restored from a cached binary
+    int compiled = 0;   // Programs compiled from source
+    int rejected = 0;   // Cached binaries the driver refused; these fell back to compiling
+    int failed = 0;     // Pairs that did not compile or link
+};
+const ShaderCacheStats& GetShaderCacheStats();
 int TextEditCallback(ImGuiInputTextCallbackData* data);
 
 
@@ -1,23 +1,300 @@
 #include "voxel.h"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+const float SQRT3 = 1.7320508f;
+
+// {dx, dz} per side for even and odd columns
+const int hexEvenColumn[HEX_SIDES][2] = { {1, 0}, {0, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+const int hexOddColumn[HEX_SIDES][2]  = { {1, 1}, {0, 1}, {-1, 1}, {-1, 0},  {0, -1}, {1, 0} };
+}
+
+void HexNeighbour(int x, int z, int side, int& nx, int& nz) {
+    const int (*table)[2] = (x & 1) ? hexOddColumn : hexEvenColumn;
+    nx = x + table[side][0];
+    nz = z + table[side][1];
+}
+
+void HexOffsetToAxial(int x, int z, int& q, int& r) {
+    q = x;
+    r = z - (x - (x & 1)) / 2;
+}
+
+void HexAxialToOffset(int q, int r, int& x, int& z) {
+    x = q;
+    z = r + (q - (q & 1)) / 2;
+}
 
 void VoxelMap::resize(int w, int h, int d) {
     width = w;
     height = h;
     depth = d;
 
-    voxels = std::vector<std::vector<std::vector<Voxel>>>(
-        depth, std::vector<std::vector<Voxel>>(
-            height, std::vector<Voxel>(
-                width, Voxel{VoxelType::Empty, "basic"}  // Default values
-            )
-        )
-    );
+    cells.assign(static_cast<size_t>(width) * height * depth, 0);
+    light.assign(cells.size(), 0xF0);
+
+    chunkCountX = (width + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+    chunkCountY = (height + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+    chunkCountZ = (depth + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+    chunkDirty.assign(static_cast<size_t>(chunkCountX) * chunkCountY * chunkCountZ, 0);
+    chunkSolidCount.assign(chunkDirty.size(), 0);
+    dirtyChunks.clear();
+    markAllDirty();
 }
 
 void VoxelMap::clear() {
-    for (auto& layer : voxels)
-        for (auto& row : layer)
-            for (auto& voxel : row)
-                voxel = Voxel{VoxelType::Empty, "basic"};
+    std::fill(cells.begin(), cells.end(), 0);
+    std::fill(chunkSolidCount.begin(), chunkSolidCount.end(), 0);
+    markAllDirty();
+}
+
+bool VoxelMap::inBounds(int x, int y, int z) const {
+    return x >= 0 && y >= 0 && z >= 0 && x < width && y < height && z < depth &&
+           cells.size() == static_cast<size_t>(width) * height * depth;
+}
+
+bool VoxelMap::isSolid(int x, int y, int z) const {
+    return inBounds(x, y, z) && cells[cellIndex(x, y, z)] != 0;
+}
+
+glm::vec3 VoxelMap::cellCenter(int x, int y, int z) const {
+    if (layout == VoxelLayout::Hex) {
+        // Prism radius is half a voxel, matching createHexPrism(0.5, 1.0) at unit size
+        const float radius = voxelSize * 0.5f;
+        return glm::vec3(x * 1.5f * radius, y * voxelSize, SQRT3 * radius * (z + 0.5f * (x & 1)));
+    }
+    return glm::vec3(x * voxelSize, y * voxelSize, z * voxelSize);
+}
+
+void VoxelMap::worldToCell(const glm::vec3& position, int& x, int& y, int& z) const {
+    y = static_cast<int>(std::floor(position.y / voxelSize + 0.5f));
+    if (layout != VoxelLayout::Hex) {
+        x = static_cast<int>(std::floor(position.x / voxelSize + 0.5f));
+        z = static_cast<int>(std::floor(position.z / voxelSize + 0.5f));
+        return;
+    }
+
+    // Fractional axial coordinates, then cube rounding to the nearest hex
+    const float radius = voxelSize * 0.5f;
+    float fq = (2.0f / 3.0f) * position.x / radius;
+    float fr = (-position.x / 3.0f + SQRT3 / 3.0f * position.z) / radius;
+    float fs = -fq - fr;
+
+    float rq = std::round(fq), rr = std::round(fr), rs = std::round(fs);
+    float dq = std::fabs(rq - fq), dr = std::fabs(rr - fr), ds = std::fabs(rs - fs);
+    if (dq > dr && dq > ds)
+        rq = -rr - rs;
+    else if (dr > ds)
+        rr = -rq - rs;
+
+    HexAxialToOffset(static_cast<int>(rq), static_cast<int>(rr), x, z);
+}
+
+const Voxel& VoxelMap::getVoxel(int x, int y, int z) const {
+    return materials[cells[cellIndex(x, y, z)]];
+}
+
+void VoxelMap::setVoxel(int x, int y, int z, const Voxel& voxel) {
+    if (!inBounds(x, y, z))
+        return;
+    uint8_t material = materialIndex(voxel);
+    uint8_t& cell = cells[cellIndex(x, y, z)];
+    if (cell == material)
+        return;
+    if ((cell != 0) != (material != 0))
+        chunkSolidCount[chunkIndex(x / VOXEL_CHUNK_SIZE, y / VOXEL_CHUNK_SIZE, z / VOXEL_CHUNK_SIZE)] += material ? 1 : -1;
+    cell = material;
+    markVoxelDirty(x, y, z);
+    recordEdit({ x, y, z, x, y, z });
+}
+
+uint8_t VoxelMap::materialIndex(const Voxel& voxel) {
+    if (voxel.type == VoxelType::Empty)
+        return 0;
+    for (size_t i = 1; i < materials.size(); ++i) {
+        if (materials[i].type == voxel.type && materials[i].shaderBase == voxel.shaderBase)
+            return static_cast<uint8_t>(i);
+    }
+    if (materials.size() > 0xFF) {
+        // Out of palette slots: reuse an entry of the same type rather than dropping the voxel
+        std::cerr << "Voxel palette is full, reusing a material for: " << voxel.shaderBase << std::endl;
+        for (size_t i = 1; i < materials.size(); ++i) {
+            if (materials[i].type == voxel.type)
+                return static_cast<uint8_t>(i);
+        }
+        return 1;
+    }
+    materials.push_back(voxel);
+    return static_cast<uint8_t>(materials.size() - 1);
+}
+
+void VoxelMap::fillRow(int x0, int x1, int y, int z, uint8_t material) {
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, width);
+    if (x0 >= x1 || y < 0 || y >= height || z < 0 || z >= depth)
+        return;
+
+    uint8_t* row = cells.data() + cellIndex(0, y, z);
+    const int cy = y / VOXEL_CHUNK_SIZE, cz = z / VOXEL_CHUNK_SIZE;
+    // Split at chunk borders so each chunk's solid count is adjusted once per segment
+    for (int start = x0; start < x1;) {
+        int end = std::min(x1, (start / VOXEL_CHUNK_SIZE + 1) * VOXEL_CHUNK_SIZE);
+        int solidBefore = static_cast<int>(end - start - std::count(row + start, row + end, uint8_t(0)));
+        std::fill(row + start, row + end, material);
+        int solidAfter = material ? end - start : 0;
+        chunkSolidCount[chunkIndex(start / VOXEL_CHUNK_SIZE, cy, cz)] += solidAfter - solidBefore;
+        start = end;
+    }
+}
+
+void VoxelMap::writeRow(int x0, int y, int z, const uint8_t* source, int count, VoxelBlend blend) {
+    int first = std::max(x0, 0);
+    int last = std::min(x0 + count, width);
+    if (first >= last || y < 0 || y >= height || z < 0 || z >= depth)
+        return;
+
+    uint8_t* row = cells.data() + cellIndex(0, y, z);
+    source += first - x0;
+    const int cy = y / VOXEL_CHUNK_SIZE, cz = z / VOXEL_CHUNK_SIZE;
+    for (int start = first; start < last;) {
+        int end = std::min(last, (start / VOXEL_CHUNK_SIZE + 1) * VOXEL_CHUNK_SIZE);
+        int delta = 0;
+        for (int x = start; x < end; ++x, ++source) {
+            uint8_t before = row[x];
+            uint8_t after = before;
+            switch (blend) {
+            case VoxelBlend::Replace:  after = *source; break;
+            case VoxelBlend::Union:    after = *source ? *source : before; break;
+            case VoxelBlend::Subtract: after = *source ? 0 : before; break;
+            }
+            row[x] = after;
+            delta += (after != 0) - (before != 0);
+        }
+        chunkSolidCount[chunkIndex(start / VOXEL_CHUNK_SIZE, cy, cz)] += delta;
+        start = end;
+    }
+}
+
+void VoxelMap::markRegionDirty(int x0, int y0, int z0, int x1, int y1, int z1) {
+    recordEdit({ x0, y0, z0, x1, y1, z1 });
+
+    // One cell of margin picks up neighbour chunks whose border faces may have changed
+    const int cx0 = std::max(x0 - 1, 0) / VOXEL_CHUNK_SIZE, cx1 = std::min(x1 + 1, width - 1) / VOXEL_CHUNK_SIZE;
+    const int cy0 = std::max(y0 - 1, 0) / VOXEL_CHUNK_SIZE, cy1 = std::min(y1 + 1, height - 1) / VOXEL_CHUNK_SIZE;
+    const int cz0 = std::max(z0 - 1, 0) / VOXEL_CHUNK_SIZE, cz1 = std::min(z1 + 1, depth - 1) / VOXEL_CHUNK_SIZE;
+    for (int cz = cz0; cz <= cz1; ++cz)
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx)
+                markChunkDirty(cx, cy, cz);
+}
+
+int VoxelMap::chunkIndex(int cx, int cy, int cz) const {
+    return (cz * chunkCountY + cy) * chunkCountX + cx;
+}
+
+void VoxelMap::chunkCoords(int index, int& cx, int& cy, int& cz) const {
+    cx = index % chunkCountX;
+    cy = (index / chunkCountX) % chunkCountY;
+    cz = index / (chunkCountX * chunkCountY);
+}
+
+void VoxelMap::markChunkDirty(int cx, int cy, int cz) {
+    if (cx < 0 || cy < 0 || cz < 0 || cx >= chunkCountX || cy >= chunkCountY || cz >= chunkCountZ)
+        return;
+    int index = chunkIndex(cx, cy, cz);
+    if (!chunkDirty[index]) {
+        chunkDirty[index] = 1;
+        dirtyChunks.push_back(index);
+    }
+}
+
+void VoxelMap::markVoxelDirty(int x, int y, int z) {
+    const int cx = x / VOXEL_CHUNK_SIZE;
+    const int cy = y / VOXEL_CHUNK_SIZE;
+    const int cz = z / VOXEL_CHUNK_SIZE;
+    markChunkDirty(cx, cy, cz);
+
+    // A voxel on a chunk border changes which faces the neighbouring chunk exposes
+    const int lx = x % VOXEL_CHUNK_SIZE;
+    const int ly = y % VOXEL_CHUNK_SIZE;
+    const int lz = z % VOXEL_CHUNK_SIZE;
+    if (lx == 0) markChunkDirty(cx - 1, cy, cz);
+    if (lx == VOXEL_CHUNK_SIZE - 1) markChunkDirty(cx + 1, cy, cz);
+    if (ly == 0) markChunkDirty(cx, cy - 1, cz);
+    if (ly == VOXEL_CHUNK_SIZE - 1) markChunkDirty(cx, cy + 1, cz);
+    if (lz == 0) markChunkDirty(cx, cy, cz - 1);
+    if (lz == VOXEL_CHUNK_SIZE - 1) markChunkDirty(cx, cy, cz + 1);
+
+    // Hex side neighbours can sit diagonally across a chunk corner, e.g. (15,15) -> (16,16)
+    if (layout == VoxelLayout::Hex) {
+        for (int side = 0; side < HEX_SIDES; ++side) {
+            int nx, nz;
+            HexNeighbour(x, z, side, nx, nz);
+            if (nx >= 0 && nz >= 0 && nx < width && nz < depth)
+                markChunkDirty(nx / VOXEL_CHUNK_SIZE, cy, nz / VOXEL_CHUNK_SIZE);
+        }
+    }
+}
+
+void VoxelMap::recordEdit(const VoxelEdit& edit) {
+    // Past this many boxes a full rebuild is cheaper than replaying them
+    const size_t maxEdits = 4096;
+    if (editsOverflowed)
+        return;
+    if (edits.size() >= maxEdits) {
+        edits.clear();
+        editsOverflowed = true;
+        return;
+    }
+    edits.push_back(edit);
+}
+
+bool VoxelMap::takeEdits(std::vector<VoxelEdit>& out) {
+    out.clear();
+    out.swap(edits);
+    bool incremental = !editsOverflowed;
+    editsOverflowed = false;
+    return incremental;
+}
+
+bool VoxelMap::peekEdits(std::vector<VoxelEdit>& out) const {
+    out = edits;
+    return !editsOverflowed;
+}
+
+void VoxelMap::markAllDirty() {
+    edits.clear();
+    editsOverflowed = true;
+    for (int cz = 0; cz < chunkCountZ; ++cz)
+        for (int cy = 0; cy < chunkCountY; ++cy)
+            for (int cx = 0; cx < chunkCountX; ++cx)
+                markChunkDirty(cx, cy, cz);
+}
+
+bool VoxelMap::isChunkEmpty(int cx, int cy, int cz) const {
+    if (cx < 0 || cy < 0 || cz < 0 || cx >= chunkCountX || cy >= chunkCountY || cz >= chunkCountZ)
+        return true;
+    return chunkSolidCount[chunkIndex(cx, cy, cz)] == 0;
+}
+
+void VoxelMap::recountChunks() {
+    std::fill(chunkSolidCount.begin(), chunkSolidCount.end(), 0);
+    for (int z = 0; z < depth; ++z)
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* row = rowData(y, z);
+            for (int x = 0; x < width; ++x)
+                if (row[x] != 0)
+                    ++chunkSolidCount[chunkIndex(x / VOXEL_CHUNK_SIZE, y / VOXEL_CHUNK_SIZE, z / VOXEL_CHUNK_SIZE)];
+        }
+}
+
+std::vector<int> VoxelMap::takeDirtyChunks() {
+    std::vector<int> result;
+    result.swap(dirtyChunks);
+    for (int index : result)
+        chunkDirty[index] = 0;
+    return result;
 }
 
@@ -1,26 +1,113 @@
 #pragma once
 #include <vector>
 #include <string>
-#include "map.h"
+#include <cstdint>
+#include <glm/glm.hpp>
 
 
-enum class VoxelType { Empty, Solid, Floor, Water };
+enum class VoxelType { Empty, Solid, Floor, Water, Light };  // Light blocks emit block light
+
+// Cube cells sit on a square lattice. Hex cells are flat-topped prisms in "odd-q" offset
+// coordinates: x is the column, z the row, and odd columns sit half a row further along +z.
+enum class VoxelLayout { Cube, Hex };
+
+constexpr int HEX_SIDES = 6;
+// Neighbour across side i of a hex cell; side i faces 30 + 60*i degrees in the XZ plane
+void HexNeighbour(int x, int z, int side, int& nx, int& nz);
+void HexOffsetToAxial(int x, int z, int& q, int& r);
+void HexAxialToOffset(int q, int r, int& x, int& z);
 
 struct Voxel {
     VoxelType type = VoxelType::Empty;
     std::string shaderBase = "basic";
 };
 
+// Voxels are meshed in cubic chunks of this many cells per side
+constexpr int VOXEL_CHUNK_SIZE = 16;
+
+// How a written span combines with what is already in the map
+enum class VoxelBlend { Replace, Union, Subtract };
+
+struct VoxelEdit { int x0, y0, z0, x1, y1, z1; };  // Inclusive cell box
+
 struct VoxelMap {
     int width = 0;
     int height = 1;
     int depth = 0;
     float voxelSize = 1.0f;
-
-    std::vector<std::vector<std::vector<Voxel>>> voxels;
+    VoxelLayout layout = VoxelLayout::Hex;
 
     void resize(int w, int h, int d);
     void clear();
-};
+    // Native chunked format, see voxelFile.h
+    [[nodiscard]] bool saveToFile(const std::string& path) const;
+    [[nodiscard]] bool loadFromFile(const std::string& path);
+
+    bool inBounds(int x, int y, int z) const;
+    bool isSolid(int x, int y, int z) const;  // Out of bounds counts as empty
+    const Voxel& getVoxel(int x, int y, int z) const;
+    glm::vec3 cellCenter(int x, int y, int z) const;
+    // Cell whose volume contains the world position (may be out of bounds)
+    void worldToCell(const glm::vec3& position, int& x, int& y, int& z) const;
+    // Writes a voxel and marks its chunk (and any touching neighbour chunk) dirty
+    void setVoxel(int x, int y, int z, const Voxel& voxel);
 
-void GenerateVoxelObjects(const VoxelMap& vmap, Map& map);
+    // Cells are stored as one byte per voxel indexing into a material palette, x fastest.
+    // Palette entry 0 is always empty; entries are added on first use and never removed.
+    const std::vector<Voxel>& palette() const { return materials; }
+    uint8_t materialIndex(const Voxel& voxel);  // Finds or adds a palette entry
+    uint8_t materialAt(int x, int y, int z) const { return cells[cellIndex(x, y, z)]; }
+    const uint8_t* rowData(int y, int z) const { return cells.data() + cellIndex(0, y, z); }
+
+    // Row kernels for bulk edits. They keep the per-chunk solid counts current but do not mark
+    // anything dirty; call markRegionDirty once for the whole batch. x1 is exclusive.
+    void fillRow(int x0, int x1, int y, int z, uint8_t material);
+    void writeRow(int x0, int y, int z, const uint8_t* source, int count, VoxelBlend blend);
+    // Marks every chunk touching the inclusive cell box, plus neighbours sharing its border
+    void markRegionDirty(int x0, int y0, int z0, int x1, int y1, int z1);
+
+    // Packed light per cell: sky light in the high nibble, block light in the low one (0-15 each).
+    // Maintained by voxelLight.h; anything outside the map counts as open sky.
+    uint8_t lightAt(int x, int y, int z) const { return inBounds(x, y, z) ? light[cellIndex(x, y, z)] : 0xF0; }
+    std::vector<uint8_t>& lightData() { return light; }
+    const std::vector<uint8_t>& lightData() const { return light; }
+    // Boxes edited since the last call, for incremental updates such as relighting. Returns false
+    // when the whole map changed (resize, load, layout change) or too many edits piled up.
+    bool takeEdits(std::vector<VoxelEdit>& out);
+    // Copies the same boxes without taking them, for readers that run before the consumer
+    bool peekEdits(std::vector<VoxelEdit>& out) const;
+
+    size_t cellIndex(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * height + y) * width + x;
+    }
+
+    // Chunk bookkeeping
+    int chunksX() const { return chunkCountX; }
+    int chunksY() const { return chunkCountY; }
+    int chunksZ() const { return chunkCountZ; }
+    int chunkIndex(int cx, int cy, int cz) const;
+    void chunkCoords(int index, int& cx, int& cy, int& cz) const;
+    void markChunkDirty(int cx, int cy, int cz);
+    void markVoxelDirty(int x, int y, int z);
+    void markAllDirty();
+    bool isChunkEmpty(int cx, int cy, int cz) const;
+    void recountChunks();  // Rebuilds the per-chunk solid counts after writing cells directly
+    bool hasDirtyChunks() const { return !dirtyChunks.empty(); }
+    std::vector<int> takeDirtyChunks();  // Returns and clears the dirty chunk list
+
+private:
+    std::vector<uint8_t> cells;
+    std::vector<Voxel> materials{ Voxel{ VoxelType::Empty, "basic" } };
+    std::vector<uint8_t> light;
+    std::vector<VoxelEdit> edits;
+    bool editsOverflowed = true;
+
+    void recordEdit(const VoxelEdit& edit);
+
+    int chunkCountX = 0;
+    int chunkCountY = 0;
+    int chunkCountZ = 0;
+    std::vector<uint8_t> chunkDirty;
+    std::vector<int> dirtyChunks;
+    std::vector<int> chunkSolidCount;
+};
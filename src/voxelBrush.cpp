@@ -0,0 +1,250 @@
+#include "voxelBrush.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Sorts an inclusive range and clips it to [0, size)
+void OrderAndClamp(int& lo, int& hi, int size) {
+    if (lo > hi)
+        std::swap(lo, hi);
+    lo = std::max(lo, 0);
+    hi = std::min(hi, size - 1);
+}
+
+uint8_t BrushMaterial(VoxelMap& vmap, const Voxel& voxel, VoxelBlend blend) {
+    return blend == VoxelBlend::Subtract ? 0 : vmap.materialIndex(voxel);
+}
+
+// Rasterizes a shape one row at a time. halfWidth(y, z) gives the shape's half extent along x
+// (world units) at a row centre, or a negative value when the row misses the shape.
+template <typename HalfWidth>
+void FillRows(VoxelMap& vmap, const glm::vec3& lo, const glm::vec3& hi, float centerX, uint8_t material,
+              HalfWidth halfWidth) {
+    if (vmap.width <= 0 || vmap.height <= 0 || vmap.depth <= 0)
+        return;
+
+    // Cell range of the bounds, padded by one for the hex layout's staggered rows
+    int ax, ay, az, bx, by, bz;
+    vmap.worldToCell(lo, ax, ay, az);
+    vmap.worldToCell(hi, bx, by, bz);
+    const int x0 = std::max(std::min(ax, bx) - 1, 0), x1 = std::min(std::max(ax, bx) + 1, vmap.width - 1);
+    const int y0 = std::max(std::min(ay, by) - 1, 0), y1 = std::min(std::max(ay, by) + 1, vmap.height - 1);
+    const int z0 = std::max(std::min(az, bz) - 1, 0), z1 = std::min(std::max(az, bz) + 1, vmap.depth - 1);
+    if (x0 > x1 || y0 > y1 || z0 > z1)
+        return;
+
+    const bool hex = vmap.layout == VoxelLayout::Hex;
+    const float spacingX = hex ? 0.75f * vmap.voxelSize : vmap.voxelSize;
+    for (int z = z0; z <= z1; ++z) {
+        for (int y = y0; y <= y1; ++y) {
+            if (!hex) {
+                const glm::vec3 rowCenter = vmap.cellCenter(0, y, z);
+                const float w = halfWidth(rowCenter.y, rowCenter.z);
+                if (w < 0.0f)
+                    continue;
+                int first = static_cast<int>(std::ceil((centerX - w) / spacingX));
+                int last = static_cast<int>(std::floor((centerX + w) / spacingX));
+                vmap.fillRow(std::max(first, x0), std::min(last, x1) + 1, y, z, material);
+                continue;
+            }
+
+            // Even and odd hex columns sit half a row apart, so each parity has its own extent
+            float w[2];
+            for (int parity = 0; parity < 2; ++parity) {
+                const glm::vec3 rowCenter = vmap.cellCenter(parity, y, z);
+                w[parity] = halfWidth(rowCenter.y, rowCenter.z);
+            }
+            if (w[0] < 0.0f && w[1] < 0.0f)
+                continue;
+            int runStart = -1;
+            for (int x = x0; x <= x1 + 1; ++x) {
+                bool inside = x <= x1 && w[x & 1] >= 0.0f && std::fabs(x * spacingX - centerX) <= w[x & 1];
+                if (inside && runStart < 0) {
+                    runStart = x;
+                } else if (!inside && runStart >= 0) {
+                    vmap.fillRow(runStart, x, y, z, material);
+                    runStart = -1;
+                }
+            }
+        }
+    }
+    vmap.markRegionDirty(x0, y0, z0, x1, y1, z1);
+}
+
+// Pushes one seed per run of `target` cells in [xFirst, xLast] of row (y, z)
+void SeedRow(const VoxelMap& vmap, int xFirst, int xLast, int y, int z, uint8_t target,
+             std::vector<glm::ivec3>& seeds) {
+    if (y < 0 || y >= vmap.height || z < 0 || z >= vmap.depth)
+        return;
+    xFirst = std::max(xFirst, 0);
+    xLast = std::min(xLast, vmap.width - 1);
+    const uint8_t* row = vmap.rowData(y, z);
+    bool inRun = false;
+    for (int x = xFirst; x <= xLast; ++x) {
+        bool match = row[x] == target;
+        if (match && !inRun)
+            seeds.push_back(glm::ivec3(x, y, z));
+        inRun = match;
+    }
+}
+}
+
+void FillVoxelBox(VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1,
+                  const Voxel& voxel, VoxelBlend blend) {
+    OrderAndClamp(x0, x1, vmap.width);
+    OrderAndClamp(y0, y1, vmap.height);
+    OrderAndClamp(z0, z1, vmap.depth);
+    if (x0 > x1 || y0 > y1 || z0 > z1)
+        return;
+
+    const uint8_t material = BrushMaterial(vmap, voxel, blend);
+    for (int z = z0; z <= z1; ++z)
+        for (int y = y0; y <= y1; ++y)
+            vmap.fillRow(x0, x1 + 1, y, z, material);
+    vmap.markRegionDirty(x0, y0, z0, x1, y1, z1);
+}
+
+void FillVoxelSphere(VoxelMap& vmap, const glm::vec3& center, float radius,
+                     const Voxel& voxel, VoxelBlend blend) {
+    const float radiusSq = radius * radius;
+    FillRows(vmap, center - glm::vec3(radius), center + glm::vec3(radius), center.x,
+             BrushMaterial(vmap, voxel, blend), [&](float y, float z) {
+                 float d = radiusSq - (y - center.y) * (y - center.y) - (z - center.z) * (z - center.z);
+                 return d >= 0.0f ? std::sqrt(d) : -1.0f;
+             });
+}
+
+void FillVoxelCylinder(VoxelMap& vmap, const glm::vec3& base, float radius, float height,
+                       const Voxel& voxel, VoxelBlend blend) {
+    const float radiusSq = radius * radius;
+    FillRows(vmap, base - glm::vec3(radius, 0.0f, radius), base + glm::vec3(radius, height, radius), base.x,
+             BrushMaterial(vmap, voxel, blend), [&](float y, float z) {
+                 if (y < base.y || y > base.y + height)
+                     return -1.0f;
+                 float d = radiusSq - (z - base.z) * (z - base.z);
+                 return d >= 0.0f ? std::sqrt(d) : -1.0f;
+             });
+}
+
+int FloodFillVoxels(VoxelMap& vmap, int x, int y, int z, const Voxel& voxel) {
+    if (!vmap.inBounds(x, y, z))
+        return 0;
+    const uint8_t target = vmap.materialAt(x, y, z);
+    const uint8_t material = vmap.materialIndex(voxel);
+    if (target == material)
+        return 0;
+
+    const bool hex = vmap.layout == VoxelLayout::Hex;
+    glm::ivec3 lo(x, y, z), hi(x, y, z);
+    int changed = 0;
+    std::vector<glm::ivec3> seeds{ glm::ivec3(x, y, z) };
+    while (!seeds.empty()) {
+        glm::ivec3 seed = seeds.back();
+        seeds.pop_back();
+        const uint8_t* row = vmap.rowData(seed.y, seed.z);
+        if (row[seed.x] != target)
+            continue;  // Already filled through another seed
+
+        // Grow the seed into the full run along x, then fill it in one go
+        int x0 = seed.x, x1 = seed.x;
+        while (x0 > 0 && row[x0 - 1] == target) --x0;
+        while (x1 < vmap.width - 1 && row[x1 + 1] == target) ++x1;
+        vmap.fillRow(x0, x1 + 1, seed.y, seed.z, material);
+        changed += x1 - x0 + 1;
+        lo = glm::ivec3(std::min(lo.x, x0), std::min(lo.y, seed.y), std::min(lo.z, seed.z));
+        hi = glm::ivec3(std::max(hi.x, x1), std::max(hi.y, seed.y), std::max(hi.z, seed.z));
+
+        SeedRow(vmap, x0, x1, seed.y - 1, seed.z, target, seeds);
+        SeedRow(vmap, x0, x1, seed.y + 1, seed.z, target, seeds);
+        if (!hex) {
+            SeedRow(vmap, x0, x1, seed.y, seed.z - 1, target, seeds);
+            SeedRow(vmap, x0, x1, seed.y, seed.z + 1, target, seeds);
+        } else {
+            // Odd columns also touch the row above diagonally, even columns the row below
+            SeedRow(vmap, x0 - (x0 & 1), x1 + (x1 & 1), seed.y, seed.z + 1, target, seeds);
+            SeedRow(vmap, x0 - !(x0 & 1), x1 + !(x1 & 1), seed.y, seed.z - 1, target, seeds);
+        }
+    }
+
+    vmap.markRegionDirty(lo.x, lo.y, lo.z, hi.x, hi.y, hi.z);
+    return changed;
+}
+
+VoxelRegion CopyVoxelRegion(const VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1) {
+    VoxelRegion region;
+    OrderAndClamp(x0, x1, vmap.width);
+    OrderAndClamp(y0, y1, vmap.height);
+    OrderAndClamp(z0, z1, vmap.depth);
+    if (x0 > x1 || y0 > y1 || z0 > z1)
+        return region;
+
+    region.sizeX = x1 - x0 + 1;
+    region.sizeY = y1 - y0 + 1;
+    region.sizeZ = z1 - z0 + 1;
+    region.palette = vmap.palette();
+    region.cells.reserve(static_cast<size_t>(region.sizeX) * region.sizeY * region.sizeZ);
+    for (int z = z0; z <= z1; ++z)
+        for (int y = y0; y <= y1; ++y) {
+            const uint8_t* row = vmap.rowData(y, z) + x0;
+            region.cells.insert(region.cells.end(), row, row + region.sizeX);
+        }
+    return region;
+}
+
+void PasteVoxelRegion(VoxelMap& vmap, const VoxelRegion& region, int x, int y, int z, VoxelBlend blend) {
+    if (region.cells.empty())
+        return;
+
+    // Translate the region's palette into the target map's, adding only materials in use
+    bool used[256] = {};
+    for (uint8_t cell : region.cells)
+        used[cell] = true;
+    uint8_t remap[256] = {};
+    for (size_t i = 1; i < region.palette.size(); ++i)
+        if (used[i])
+            remap[i] = vmap.materialIndex(region.palette[i]);
+
+    std::vector<uint8_t> row(region.sizeX);
+    const uint8_t* source = region.cells.data();
+    for (int rz = 0; rz < region.sizeZ; ++rz) {
+        for (int ry = 0; ry < region.sizeY; ++ry, source += region.sizeX) {
+            for (int rx = 0; rx < region.sizeX; ++rx)
+                row[rx] = remap[source[rx]];
+            vmap.writeRow(x, y + ry, z + rz, row.data(), region.sizeX, blend);
+        }
+    }
+    vmap.markRegionDirty(x, y, z, x + region.sizeX - 1, y + region.sizeY - 1, z + region.sizeZ - 1);
+}
+
+void BenchmarkVoxelBrushes() {
+    const int size = 256;
+    VoxelMap scratch;
+    scratch.layout = VoxelLayout::Cube;
+    scratch.resize(size, size, size);
+    const Voxel solid{ VoxelType::Solid, "basic" };
+    const Voxel floor{ VoxelType::Floor, "basic" };
+    const glm::vec3 middle = scratch.cellCenter(size / 2, size / 2, size / 2);
+
+    auto time = [](const char* label, auto&& operation) {
+        auto start = std::chrono::high_resolution_clock::now();
+        operation();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "[Voxel] " << label << ": " << ms << " ms" << std::endl;
+    };
+
+    std::cout << "[Voxel] Brush benchmark on a " << size << "^3 map" << std::endl;
+    time("box fill (all cells)", [&] { FillVoxelBox(scratch, 0, 0, 0, size - 1, size - 1, size - 1, solid); });
+    time("sphere subtract (r=100)", [&] { FillVoxelSphere(scratch, middle, 100.0f, solid, VoxelBlend::Subtract); });
+    int filled = 0;
+    time("flood fill sphere cavity", [&] { filled = FloodFillVoxels(scratch, size / 2, size / 2, size / 2, floor); });
+    std::cout << "[Voxel]   flood filled " << filled << " cells" << std::endl;
+    time("cylinder union (r=60, h=200)", [&] {
+        FillVoxelCylinder(scratch, middle - glm::vec3(0.0f, 100.0f, 0.0f), 60.0f, 200.0f, solid);
+    });
+    VoxelRegion region;
+    time("copy 128^3 region", [&] { region = CopyVoxelRegion(scratch, 0, 0, 0, 127, 127, 127); });
+    time("paste 128^3 region (union)", [&] { PasteVoxelRegion(scratch, region, 128, 128, 128, VoxelBlend::Union); });
+    std::cout << "[Voxel]   " << scratch.takeDirtyChunks().size() << " chunks queued for remeshing" << std::endl;
+}
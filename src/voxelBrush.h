@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "voxel.h"
+
+// Bulk voxel edits. Every operation writes whole rows through VoxelMap's row kernels and marks
+// the touched chunks dirty once, so a large fill costs one remesh batch rather than one per cell.
+// Union fills with the given voxel, Subtract clears; Replace only differs from Union when pasting.
+
+// Inclusive cell box
+void FillVoxelBox(VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1,
+                  const Voxel& voxel, VoxelBlend blend = VoxelBlend::Union);
+// Cells whose centre lies inside the sphere (world units)
+void FillVoxelSphere(VoxelMap& vmap, const glm::vec3& center, float radius,
+                     const Voxel& voxel, VoxelBlend blend = VoxelBlend::Union);
+// Vertical cylinder standing on `base` (world units)
+void FillVoxelCylinder(VoxelMap& vmap, const glm::vec3& base, float radius, float height,
+                       const Voxel& voxel, VoxelBlend blend = VoxelBlend::Union);
+// Scanline flood fill of the face-connected region sharing the seed cell's material.
+// Returns the number of cells changed.
+int FloodFillVoxels(VoxelMap& vmap, int x, int y, int z, const Voxel& voxel);
+
+// A copied block of cells with its own palette, so it can be pasted into any map
+struct VoxelRegion {
+    int sizeX = 0, sizeY = 0, sizeZ = 0;
+    std::vector<Voxel> palette;
+    std::vector<uint8_t> cells;  // x fastest
+};
+
+VoxelRegion CopyVoxelRegion(const VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1);
+void PasteVoxelRegion(VoxelMap& vmap, const VoxelRegion& region, int x, int y, int z,
+                      VoxelBlend blend = VoxelBlend::Replace);
+
+// Times each operation on a scratch 256^3 map and prints the results
+void BenchmarkVoxelBrushes();
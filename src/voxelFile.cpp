@@ -0,0 +1,508 @@
+#include "voxelFile.h"
+#include "voxel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VOXEL_FILE_USE_MMAP 1
+#endif
+
+namespace {
+
+const char VOXEL_FILE_MAGIC[4] = { 'L', 'V', 'O', 'X' };
+const uint32_t VOXEL_FILE_VERSION = 1;
+const size_t HEADER_SIZE = 40;
+const size_t DIRECTORY_ENTRY_SIZE = 13;
+// Far beyond any editor map; keeps a corrupt header from asking resize() for terabytes
+const int32_t MAX_DIMENSION = 4096;
+const uint64_t MAX_CELLS = uint64_t(1) << 28;
+
+template <typename T>
+void appendPod(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool readPod(const uint8_t* data, size_t size, size_t& pos, T& value) {
+    if (pos + sizeof(T) > size)
+        return false;
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+void chunkExtent(int width, int height, int depth, int cx, int cy, int cz, int& sx, int& sy, int& sz) {
+    sx = std::min(VOXEL_CHUNK_SIZE, width - cx * VOXEL_CHUNK_SIZE);
+    sy = std::min(VOXEL_CHUNK_SIZE, height - cy * VOXEL_CHUNK_SIZE);
+    sz = std::min(VOXEL_CHUNK_SIZE, depth - cz * VOXEL_CHUNK_SIZE);
+}
+
+// (run length, palette index) pairs
+std::vector<uint8_t> encodeRunLength(const std::vector<uint16_t>& cells) {
+    std::vector<uint8_t> out;
+    size_t i = 0;
+    while (i < cells.size()) {
+        size_t run = 1;
+        while (i + run < cells.size() && cells[i + run] == cells[i] && run < 0xFFFF)
+            ++run;
+        appendPod(out, static_cast<uint16_t>(run));
+        appendPod(out, cells[i]);
+        i += run;
+    }
+    return out;
+}
+
+// Local palette of global indices followed by ceil(log2(n))-bit cell codes, LSB first
+std::vector<uint8_t> encodeBitPacked(const std::vector<uint16_t>& cells) {
+    std::vector<uint16_t> local;
+    for (uint16_t cell : cells) {
+        if (std::find(local.begin(), local.end(), cell) == local.end())
+            local.push_back(cell);
+    }
+
+    int bits = 1;
+    while ((1u << bits) < local.size())
+        ++bits;
+
+    std::vector<uint8_t> out;
+    appendPod(out, static_cast<uint16_t>(local.size()));
+    for (uint16_t index : local)
+        appendPod(out, index);
+
+    size_t packedStart = out.size();
+    out.resize(packedStart + (cells.size() * bits + 7) / 8, 0);
+    size_t bitPos = 0;
+    for (uint16_t cell : cells) {
+        uint32_t code = static_cast<uint32_t>(std::find(local.begin(), local.end(), cell) - local.begin());
+        for (int b = 0; b < bits; ++b, ++bitPos) {
+            if (code & (1u << b))
+                out[packedStart + bitPos / 8] |= static_cast<uint8_t>(1u << (bitPos % 8));
+        }
+    }
+    return out;
+}
+
+// Length of the line the per-voxel text map used to write for one voxel
+size_t perVoxelTextLineLength(const Voxel& voxel, int x, int y, int z, float size) {
+    char line[512];
+    int length = std::snprintf(line, sizeof(line),
+        "\"Voxel_%d_%d_%d\" \"HexPrism\" %g %g %g 0 0 0 %g %g %g \"%s.vert\" \"%s.frag\"\n",
+        x, y, z, x * size, y * size, z * size, size, size, size,
+        voxel.shaderBase.c_str(), voxel.shaderBase.c_str());
+    return length > 0 ? static_cast<size_t>(length) : 0;
+}
+
+} // namespace
+
+bool VoxelMap::saveToFile(const std::string& path) const {
+    // The map's own material palette is written as-is; index 0 is reserved for empty cells
+    const std::vector<Voxel>& palette = materials;
+    size_t perVoxelTextBytes = 0;
+    for (int z = 0; z < depth; ++z)
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                if (isSolid(x, y, z))
+                    perVoxelTextBytes += perVoxelTextLineLength(getVoxel(x, y, z), x, y, z, voxelSize);
+
+    std::vector<uint8_t> file;
+    file.insert(file.end(), VOXEL_FILE_MAGIC, VOXEL_FILE_MAGIC + 4);
+    appendPod(file, VOXEL_FILE_VERSION);
+    appendPod(file, static_cast<int32_t>(width));
+    appendPod(file, static_cast<int32_t>(height));
+    appendPod(file, static_cast<int32_t>(depth));
+    appendPod(file, voxelSize);
+    appendPod(file, static_cast<uint8_t>(layout));
+    appendPod(file, static_cast<uint8_t>(VOXEL_CHUNK_SIZE));
+    appendPod(file, static_cast<uint16_t>(0));
+    appendPod(file, static_cast<uint32_t>(palette.size()));
+    appendPod(file, static_cast<uint64_t>(0));  // Directory offset, patched below
+
+    for (const Voxel& material : palette) {
+        appendPod(file, static_cast<uint8_t>(material.type));
+        appendPod(file, static_cast<uint32_t>(material.shaderBase.size()));
+        file.insert(file.end(), material.shaderBase.begin(), material.shaderBase.end());
+    }
+
+    std::vector<uint8_t> directory;
+    std::vector<uint16_t> chunkCells;
+    const int chunkCount = chunksX() * chunksY() * chunksZ();
+    for (int index = 0; index < chunkCount; ++index) {
+        int cx, cy, cz, sx, sy, sz;
+        chunkCoords(index, cx, cy, cz);
+        chunkExtent(width, height, depth, cx, cy, cz, sx, sy, sz);
+
+        chunkCells.clear();
+        const bool empty = isChunkEmpty(cx, cy, cz);
+        for (int lz = 0; lz < sz && !empty; ++lz)
+            for (int ly = 0; ly < sy; ++ly) {
+                const uint8_t* row = rowData(cy * VOXEL_CHUNK_SIZE + ly, cz * VOXEL_CHUNK_SIZE + lz) + cx * VOXEL_CHUNK_SIZE;
+                chunkCells.insert(chunkCells.end(), row, row + sx);
+            }
+
+        VoxelChunkEncoding encoding = VoxelChunkEncoding::Empty;
+        std::vector<uint8_t> payload;
+        if (!empty) {
+            std::vector<uint8_t> runLength = encodeRunLength(chunkCells);
+            std::vector<uint8_t> bitPacked = encodeBitPacked(chunkCells);
+            if (runLength.size() <= bitPacked.size()) {
+                encoding = VoxelChunkEncoding::RunLength;
+                payload.swap(runLength);
+            } else {
+                encoding = VoxelChunkEncoding::BitPacked;
+                payload.swap(bitPacked);
+            }
+        }
+
+        appendPod(directory, static_cast<uint64_t>(file.size()));
+        appendPod(directory, static_cast<uint32_t>(payload.size()));
+        appendPod(directory, static_cast<uint8_t>(encoding));
+        file.insert(file.end(), payload.begin(), payload.end());
+    }
+
+    uint64_t directoryOffset = file.size();
+    std::memcpy(file.data() + 32, &directoryOffset, sizeof(directoryOffset));
+    appendPod(file, static_cast<uint32_t>(chunkCount));
+    file.insert(file.end(), directory.begin(), directory.end());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open voxel file for writing: " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    if (!out) {
+        std::cerr << "Failed to write voxel file: " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "Voxel map saved to: " << path << " (" << file.size() << " bytes, "
+              << palette.size() - 1 << " materials; per-voxel text map would be "
+              << perVoxelTextBytes << " bytes";
+    if (file.size() > 0 && perVoxelTextBytes > 0)
+        std::cout << ", " << static_cast<double>(perVoxelTextBytes) / file.size() << "x larger";
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+bool VoxelMap::loadFromFile(const std::string& path) {
+    VoxelFileReader reader;
+    if (!reader.open(path))
+        return false;
+
+    // Decode into a scratch map so a corrupt chunk leaves this one untouched
+    VoxelMap loaded;
+    loaded.voxelSize = reader.voxelSize();
+    loaded.layout = reader.layout();
+    loaded.resize(reader.width(), reader.height(), reader.depth());
+
+    // Map the file palette onto a fresh map palette
+    std::vector<uint8_t> remap;
+    for (const Voxel& material : reader.palette())
+        remap.push_back(loaded.materialIndex(material));
+
+    std::vector<uint16_t> chunkCells;
+    for (int cz = 0; cz < reader.chunksZ(); ++cz) {
+        for (int cy = 0; cy < reader.chunksY(); ++cy) {
+            for (int cx = 0; cx < reader.chunksX(); ++cx) {
+                if (!reader.readChunk(cx, cy, cz, chunkCells)) {
+                    std::cerr << "Corrupt voxel chunk " << cx << "," << cy << "," << cz << " in: " << path << std::endl;
+                    return false;
+                }
+
+                int sx, sy, sz;
+                chunkExtent(loaded.width, loaded.height, loaded.depth, cx, cy, cz, sx, sy, sz);
+                size_t i = 0;
+                for (int lz = 0; lz < sz; ++lz)
+                    for (int ly = 0; ly < sy; ++ly)
+                        for (int lx = 0; lx < sx; ++lx, ++i)
+                            loaded.cells[loaded.cellIndex(cx * VOXEL_CHUNK_SIZE + lx, cy * VOXEL_CHUNK_SIZE + ly, cz * VOXEL_CHUNK_SIZE + lz)] =
+                                remap[chunkCells[i]];
+            }
+        }
+    }
+
+    loaded.recountChunks();
+    loaded.markAllDirty();
+    *this = std::move(loaded);
+    return true;
+}
+
+VoxelFileReader::~VoxelFileReader() {
+    close();
+}
+
+void VoxelFileReader::close() {
+#ifdef VOXEL_FILE_USE_MMAP
+    if (mapped && data)
+        munmap(const_cast<uint8_t*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+    palette_.clear();
+    directory.clear();
+}
+
+bool VoxelFileReader::open(const std::string& path) {
+    close();
+
+#ifdef VOXEL_FILE_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(view);
+                size = static_cast<size_t>(st.st_size);
+                mapped = true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    if (!data) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Failed to open voxel file for reading: " << path << std::endl;
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    size_t pos = 0;
+    uint32_t version = 0, paletteCount = 0;
+    int32_t w = 0, h = 0, d = 0;
+    uint8_t layout = 0, chunkSize = 0;
+    uint16_t reserved = 0;
+    uint64_t directoryOffset = 0;
+
+    if (size < HEADER_SIZE || std::memcmp(data, VOXEL_FILE_MAGIC, 4) != 0) {
+        std::cerr << "Not a voxel file: " << path << std::endl;
+        close();
+        return false;
+    }
+    pos = 4;
+    bool ok = readPod(data, size, pos, version) && readPod(data, size, pos, w) &&
+              readPod(data, size, pos, h) && readPod(data, size, pos, d) &&
+              readPod(data, size, pos, voxelSize_) && readPod(data, size, pos, layout) &&
+              readPod(data, size, pos, chunkSize) && readPod(data, size, pos, reserved) &&
+              readPod(data, size, pos, paletteCount) && readPod(data, size, pos, directoryOffset);
+
+    if (!ok || version != VOXEL_FILE_VERSION || chunkSize != VOXEL_CHUNK_SIZE || w < 0 || h < 0 || d < 0 ||
+        w > MAX_DIMENSION || h > MAX_DIMENSION || d > MAX_DIMENSION ||
+        static_cast<uint64_t>(w) * h * d > MAX_CELLS || paletteCount == 0 || paletteCount > 0x10000) {
+        std::cerr << "Unsupported voxel file header: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    width_ = w;
+    height_ = h;
+    depth_ = d;
+    layout_ = layout == static_cast<uint8_t>(VoxelLayout::Hex) ? VoxelLayout::Hex : VoxelLayout::Cube;
+    chunksX_ = (w + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+    chunksY_ = (h + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+    chunksZ_ = (d + VOXEL_CHUNK_SIZE - 1) / VOXEL_CHUNK_SIZE;
+
+    for (uint32_t i = 0; i < paletteCount; ++i) {
+        uint8_t type = 0;
+        uint32_t length = 0;
+        if (!readPod(data, size, pos, type) || !readPod(data, size, pos, length) || pos + length > size) {
+            std::cerr << "Truncated voxel palette: " << path << std::endl;
+            close();
+            return false;
+        }
+        palette_.push_back(Voxel{ static_cast<VoxelType>(type),
+                                  std::string(reinterpret_cast<const char*>(data + pos), length) });
+        pos += length;
+    }
+
+    uint32_t chunkCount = 0;
+    pos = static_cast<size_t>(directoryOffset);
+    if (directoryOffset > size || !readPod(data, size, pos, chunkCount) ||
+        chunkCount != static_cast<uint64_t>(chunksX_) * chunksY_ * chunksZ_ ||
+        pos + static_cast<size_t>(chunkCount) * DIRECTORY_ENTRY_SIZE > size) {
+        std::cerr << "Corrupt voxel chunk directory: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    directory.resize(chunkCount);
+    for (auto& entry : directory) {
+        uint8_t encoding = 0;
+        readPod(data, size, pos, entry.offset);
+        readPod(data, size, pos, entry.size);
+        readPod(data, size, pos, encoding);
+        entry.encoding = static_cast<VoxelChunkEncoding>(encoding);
+        if (entry.size > directoryOffset || entry.offset > directoryOffset - entry.size) {
+            std::cerr << "Voxel chunk outside of file data: " << path << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VoxelChunkEncoding VoxelFileReader::chunkEncoding(int cx, int cy, int cz) const {
+    if (cx < 0 || cy < 0 || cz < 0 || cx >= chunksX_ || cy >= chunksY_ || cz >= chunksZ_)
+        return VoxelChunkEncoding::Empty;
+    return directory[(cz * chunksY_ + cy) * chunksX_ + cx].encoding;
+}
+
+bool VoxelFileReader::readChunk(int cx, int cy, int cz, std::vector<uint16_t>& cells) const {
+    if (cx < 0 || cy < 0 || cz < 0 || cx >= chunksX_ || cy >= chunksY_ || cz >= chunksZ_)
+        return false;
+
+    int sx, sy, sz;
+    chunkExtent(width_, height_, depth_, cx, cy, cz, sx, sy, sz);
+    const size_t cellCount = static_cast<size_t>(sx) * sy * sz;
+    cells.assign(cellCount, 0);
+
+    const DirectoryEntry& entry = directory[(cz * chunksY_ + cy) * chunksX_ + cx];
+    const uint8_t* payload = data + entry.offset;
+    const size_t payloadSize = entry.size;
+    size_t pos = 0;
+
+    switch (entry.encoding) {
+    case VoxelChunkEncoding::Empty:
+        return true;
+
+    case VoxelChunkEncoding::RunLength: {
+        size_t filled = 0;
+        while (pos < payloadSize) {
+            uint16_t run = 0, index = 0;
+            if (!readPod(payload, payloadSize, pos, run) || !readPod(payload, payloadSize, pos, index) ||
+                filled + run > cellCount || index >= palette_.size())
+                return false;
+            std::fill(cells.begin() + filled, cells.begin() + filled + run, index);
+            filled += run;
+        }
+        return filled == cellCount;
+    }
+
+    case VoxelChunkEncoding::BitPacked: {
+        uint16_t localCount = 0;
+        if (!readPod(payload, payloadSize, pos, localCount) || localCount == 0)
+            return false;
+        std::vector<uint16_t> local(localCount);
+        for (auto& index : local) {
+            if (!readPod(payload, payloadSize, pos, index) || index >= palette_.size())
+                return false;
+        }
+
+        int bits = 1;
+        while ((1u << bits) < localCount)
+            ++bits;
+        if (pos + (cellCount * bits + 7) / 8 > payloadSize)
+            return false;
+
+        size_t bitPos = 0;
+        for (size_t i = 0; i < cellCount; ++i) {
+            uint32_t code = 0;
+            for (int b = 0; b < bits; ++b, ++bitPos) {
+                if (payload[pos + bitPos / 8] & (1u << (bitPos % 8)))
+                    code |= 1u << b;
+            }
+            if (code >= localCount)
+                return false;
+            cells[i] = local[code];
+        }
+        return true;
+    }
+    }
+
+    return false;
+}
+
+void BenchmarkVoxelFileRoundTrip() {
+    const Voxel materials[] = { { VoxelType::Solid, "voxel_lit" }, { VoxelType::Floor, "basic" },
+                                { VoxelType::Water, "voxel_lit" }, { VoxelType::Light, "voxel_lit" } };
+    const std::string path = (std::filesystem::temp_directory_path() / "voxel_roundtrip.lvox").string();
+
+    std::cout << "[Voxel] File round trip" << std::endl;
+    for (VoxelLayout layout : { VoxelLayout::Cube, VoxelLayout::Hex }) {
+        // Bottom chunk layer is solid (run-length), the next is noise over half the map
+        // (bit-packed) and everything above it is empty
+        VoxelMap source;
+        source.layout = layout;
+        source.voxelSize = 0.75f;
+        source.resize(80, 40, 80);
+        uint8_t indices[4];
+        for (int i = 0; i < 4; ++i)
+            indices[i] = source.materialIndex(materials[i]);
+        for (int z = 0; z < source.depth; ++z) {
+            for (int y = 0; y < VOXEL_CHUNK_SIZE; ++y)
+                source.fillRow(0, source.width, y, z, indices[0]);
+            for (int y = VOXEL_CHUNK_SIZE; y < 2 * VOXEL_CHUNK_SIZE; ++y)
+                for (int x = 0; x < 3 * VOXEL_CHUNK_SIZE; ++x) {
+                    uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^
+                                    static_cast<uint32_t>(z) * 83492791u;
+                    hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+                    const uint32_t pick = (hash >> 16) % 5;
+                    if (pick < 4)
+                        source.fillRow(x, x + 1, y, z, indices[pick]);
+                }
+        }
+        source.recountChunks();
+
+        size_t textBytes = 0;
+        for (int z = 0; z < source.depth; ++z)
+            for (int y = 0; y < source.height; ++y)
+                for (int x = 0; x < source.width; ++x)
+                    if (source.isSolid(x, y, z))
+                        textBytes += perVoxelTextLineLength(source.getVoxel(x, y, z), x, y, z, source.voxelSize);
+
+        const char* name = layout == VoxelLayout::Hex ? "Hex" : "Cube";
+        auto start = std::chrono::steady_clock::now();
+        if (!source.saveToFile(path)) {
+            std::cerr << "  " << name << ": save failed" << std::endl;
+            continue;
+        }
+        auto saved = std::chrono::steady_clock::now();
+        VoxelMap loaded;
+        if (!loaded.loadFromFile(path)) {
+            std::cerr << "  " << name << ": load failed" << std::endl;
+            continue;
+        }
+        auto done = std::chrono::steady_clock::now();
+
+        int encodings[3] = { 0, 0, 0 };
+        size_t fileBytes = 0;
+        VoxelFileReader reader;
+        if (reader.open(path)) {
+            fileBytes = reader.fileSize();
+            for (int cz = 0; cz < reader.chunksZ(); ++cz)
+                for (int cy = 0; cy < reader.chunksY(); ++cy)
+                    for (int cx = 0; cx < reader.chunksX(); ++cx)
+                        ++encodings[static_cast<int>(reader.chunkEncoding(cx, cy, cz))];
+        }
+
+        std::cout << "  " << name << ": " << encodings[0] << " empty / " << encodings[1] << " run-length / " << encodings[2]
+                  << " bit-packed chunks, " << fileBytes << " bytes vs " << textBytes << " as text";
+        if (fileBytes > 0)
+            std::cout << " (" << static_cast<double>(textBytes) / fileBytes << "x smaller)";
+        std::cout << ", save " << std::chrono::duration<double, std::milli>(saved - start).count()
+                  << " ms, load " << std::chrono::duration<double, std::milli>(done - saved).count() << " ms"
+                  << std::endl;
+    }
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
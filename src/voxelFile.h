@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "voxel.h"
+
+// Native voxel file (.lvox):
+//   header | material palette | chunk payloads | chunk directory
+// Each chunk payload is either run-length encoded or bit-packed against a per-chunk palette,
+// whichever is smaller. The directory stores each chunk's offset, so a single chunk can be
+// decoded without parsing the rest of the file.
+
+enum class VoxelChunkEncoding : uint8_t { Empty = 0, RunLength = 1, BitPacked = 2 };
+
+// Streams chunks out of a .lvox file. The file is memory-mapped where the platform supports it
+// and read into memory otherwise.
+class VoxelFileReader {
+public:
+    VoxelFileReader() = default;
+    ~VoxelFileReader();
+    VoxelFileReader(const VoxelFileReader&) = delete;
+    VoxelFileReader& operator=(const VoxelFileReader&) = delete;
+
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int depth() const { return depth_; }
+    float voxelSize() const { return voxelSize_; }
+    VoxelLayout layout() const { return layout_; }
+    int chunksX() const { return chunksX_; }
+    int chunksY() const { return chunksY_; }
+    int chunksZ() const { return chunksZ_; }
+    const std::vector<Voxel>& palette() const { return palette_; }  // Index 0 is always empty
+
+    // Decodes one chunk into palette indices, x fastest, covering only the cells inside the map
+    [[nodiscard]] bool readChunk(int cx, int cy, int cz, std::vector<uint16_t>& cells) const;
+    VoxelChunkEncoding chunkEncoding(int cx, int cy, int cz) const;
+    size_t fileSize() const { return size; }
+
+private:
+    struct DirectoryEntry {
+        uint64_t offset;
+        uint32_t size;
+        VoxelChunkEncoding encoding;
+    };
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::vector<uint8_t> buffer;  // Used when mmap is unavailable
+
+    int width_ = 0, height_ = 0, depth_ = 0;
+    float voxelSize_ = 1.0f;
+    VoxelLayout layout_ = VoxelLayout::Cube;
+    int chunksX_ = 0, chunksY_ = 0, chunksZ_ = 0;
+    std::vector<Voxel> palette_;
+    std::vector<DirectoryEntry> directory;
+};
+
+// Saves and reloads cube and hex scratch maps covering every chunk encoding and prints the
+// timings and file size against the text format. tests/editorTests.cpp checks the round trip.
+void BenchmarkVoxelFileRoundTrip();
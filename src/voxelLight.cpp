@@ -0,0 +1,329 @@
+#include "voxelLight.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+enum LightChannel { SKY = 0, BLOCK = 1 };
+
+struct LightNode {
+    int x, y, z;
+    uint8_t value;
+};
+
+// Breadth-first light propagation over one map. Each channel has an add queue (cells whose light
+// should spread to their neighbours) and a removal queue (cells whose old light must be taken back).
+class LightFlood {
+public:
+    LightFlood(VoxelMap& vmap, bool markChanges) : vmap(vmap), light(vmap.lightData()), markChanges(markChanges) {
+        const std::vector<Voxel>& palette = vmap.palette();
+        for (size_t m = 0; m < 256; ++m) {
+            VoxelType type = m < palette.size() ? palette[m].type : VoxelType::Solid;
+            opaque[m] = m != 0 && type != VoxelType::Water;
+            cost[m] = type == VoxelType::Water ? 2 : 1;
+            emits[m] = m != 0 && type == VoxelType::Light;
+        }
+    }
+
+    void relightAll();
+    void relightEdits(const std::vector<VoxelEdit>& edits);
+
+private:
+    VoxelMap& vmap;
+    std::vector<uint8_t>& light;
+    bool markChanges;
+    bool opaque[256];
+    uint8_t cost[256];
+    bool emits[256];
+    std::vector<LightNode> addQueue[2];
+    std::vector<LightNode> removeQueue[2];
+
+    // Cells that pass full sky light straight down (open air, not water)
+    bool fullSky(uint8_t material) const { return !opaque[material] && cost[material] == 1; }
+
+    uint8_t get(size_t i, int channel) const {
+        return channel == SKY ? light[i] >> 4 : light[i] & 0x0F;
+    }
+
+    void set(int x, int y, int z, size_t i, int channel, uint8_t value) {
+        light[i] = channel == SKY ? static_cast<uint8_t>((light[i] & 0x0F) | (value << 4))
+                                  : static_cast<uint8_t>((light[i] & 0xF0) | value);
+        if (markChanges)
+            vmap.markVoxelDirty(x, y, z);  // Faces next to this cell bake its light
+    }
+
+    // Writes the neighbours of a cell (in or out of bounds); out[0] is always the cell below
+    int neighbours(int x, int y, int z, glm::ivec3 out[8]) const {
+        out[0] = glm::ivec3(x, y - 1, z);
+        out[1] = glm::ivec3(x, y + 1, z);
+        if (vmap.layout == VoxelLayout::Hex) {
+            for (int side = 0; side < HEX_SIDES; ++side) {
+                int nx, nz;
+                HexNeighbour(x, z, side, nx, nz);
+                out[2 + side] = glm::ivec3(nx, y, nz);
+            }
+            return 2 + HEX_SIDES;
+        }
+        out[2] = glm::ivec3(x + 1, y, z);
+        out[3] = glm::ivec3(x - 1, y, z);
+        out[4] = glm::ivec3(x, y, z + 1);
+        out[5] = glm::ivec3(x, y, z - 1);
+        return 6;
+    }
+
+    bool inside(const glm::ivec3& c) const {
+        return c.x >= 0 && c.y >= 0 && c.z >= 0 && c.x < vmap.width && c.y < vmap.height && c.z < vmap.depth;
+    }
+
+    void seed(int x, int y, int z, int channel, uint8_t value) {
+        size_t i = vmap.cellIndex(x, y, z);
+        if (get(i, channel) >= value)
+            return;
+        set(x, y, z, i, channel, value);
+        addQueue[channel].push_back({ x, y, z, value });
+    }
+
+    // Queues every lit neighbour of the edited box so light flows back in from its edge
+    void seedFromShell(const VoxelEdit& e);
+    void propagate(int channel);
+    void remove(int channel);
+};
+
+void LightFlood::propagate(int channel) {
+    std::vector<LightNode>& queue = addQueue[channel];
+    glm::ivec3 n[8];
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const LightNode node = queue[head];
+        const uint8_t value = get(vmap.cellIndex(node.x, node.y, node.z), channel);
+        if (value <= 1)
+            continue;
+
+        const int count = neighbours(node.x, node.y, node.z, n);
+        for (int k = 0; k < count; ++k) {
+            if (!inside(n[k]))
+                continue;
+            const size_t j = vmap.cellIndex(n[k].x, n[k].y, n[k].z);
+            const uint8_t material = vmap.materialAt(n[k].x, n[k].y, n[k].z);
+            if (opaque[material] || value <= cost[material])
+                continue;
+
+            // Full sky light falls straight down through open air without fading
+            uint8_t next = (channel == SKY && k == 0 && value == VOXEL_MAX_LIGHT && fullSky(material))
+                               ? VOXEL_MAX_LIGHT : static_cast<uint8_t>(value - cost[material]);
+            if (next > get(j, channel)) {
+                set(n[k].x, n[k].y, n[k].z, j, channel, next);
+                queue.push_back({ n[k].x, n[k].y, n[k].z, next });
+            }
+        }
+    }
+    queue.clear();
+}
+
+void LightFlood::remove(int channel) {
+    std::vector<LightNode>& queue = removeQueue[channel];
+    glm::ivec3 n[8];
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const LightNode node = queue[head];
+        const int count = neighbours(node.x, node.y, node.z, n);
+        for (int k = 0; k < count; ++k) {
+            if (!inside(n[k]))
+                continue;
+            const size_t j = vmap.cellIndex(n[k].x, n[k].y, n[k].z);
+            const uint8_t value = get(j, channel);
+            if (value == 0)
+                continue;
+
+            // Light that could only have come from the removed cell goes too; anything brighter
+            // has another source and is queued to flood back into the gap
+            const bool fedByNode = value < node.value ||
+                (channel == SKY && k == 0 && node.value == VOXEL_MAX_LIGHT && value == VOXEL_MAX_LIGHT);
+            const bool emitter = channel == BLOCK && emits[vmap.materialAt(n[k].x, n[k].y, n[k].z)];
+            if (fedByNode && !emitter) {
+                set(n[k].x, n[k].y, n[k].z, j, channel, 0);
+                queue.push_back({ n[k].x, n[k].y, n[k].z, value });
+            } else {
+                addQueue[channel].push_back({ n[k].x, n[k].y, n[k].z, value });
+            }
+        }
+    }
+    queue.clear();
+}
+
+void LightFlood::seedFromShell(const VoxelEdit& e) {
+    glm::ivec3 n[8];
+    for (int z = e.z0; z <= e.z1; ++z) {
+        for (int y = e.y0; y <= e.y1; ++y) {
+            const bool faceRow = z == e.z0 || z == e.z1 || y == e.y0 || y == e.y1;
+            const int step = faceRow ? 1 : std::max(e.x1 - e.x0, 1);
+            for (int x = e.x0; x <= e.x1; x += step) {
+                if (opaque[vmap.materialAt(x, y, z)])
+                    continue;
+                const int count = neighbours(x, y, z, n);
+                for (int k = 0; k < count; ++k) {
+                    if (!inside(n[k]))
+                        continue;
+                    const size_t j = vmap.cellIndex(n[k].x, n[k].y, n[k].z);
+                    for (int channel = SKY; channel <= BLOCK; ++channel) {
+                        uint8_t value = get(j, channel);
+                        if (value > 1)
+                            addQueue[channel].push_back({ n[k].x, n[k].y, n[k].z, value });
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightFlood::relightAll() {
+    std::fill(light.begin(), light.end(), 0);
+
+    // Sky: every column is lit from the top down to the first cell that is not open air
+    for (int z = 0; z < vmap.depth; ++z) {
+        for (int x = 0; x < vmap.width; ++x) {
+            for (int y = vmap.height - 1; y >= 0; --y) {
+                if (!fullSky(vmap.materialAt(x, y, z)))
+                    break;
+                seed(x, y, z, SKY, VOXEL_MAX_LIGHT);
+            }
+        }
+    }
+
+    for (int z = 0; z < vmap.depth; ++z)
+        for (int y = 0; y < vmap.height; ++y) {
+            const uint8_t* row = vmap.rowData(y, z);
+            for (int x = 0; x < vmap.width; ++x)
+                if (emits[row[x]])
+                    seed(x, y, z, BLOCK, VOXEL_MAX_LIGHT);
+        }
+
+    propagate(SKY);
+    propagate(BLOCK);
+}
+
+void LightFlood::relightEdits(const std::vector<VoxelEdit>& edits) {
+    std::vector<VoxelEdit> boxes;
+    for (VoxelEdit e : edits) {
+        e.x0 = std::max(e.x0, 0); e.x1 = std::min(e.x1, vmap.width - 1);
+        e.y0 = std::max(e.y0, 0); e.y1 = std::min(e.y1, vmap.height - 1);
+        e.z0 = std::max(e.z0, 0); e.z1 = std::min(e.z1, vmap.depth - 1);
+        if (e.x0 <= e.x1 && e.y0 <= e.y1 && e.z0 <= e.z1)
+            boxes.push_back(e);
+    }
+
+    // Take back all light inside the edited boxes and whatever it fed
+    for (const VoxelEdit& e : boxes) {
+        for (int z = e.z0; z <= e.z1; ++z)
+            for (int y = e.y0; y <= e.y1; ++y)
+                for (int x = e.x0; x <= e.x1; ++x) {
+                    const size_t i = vmap.cellIndex(x, y, z);
+                    for (int channel = SKY; channel <= BLOCK; ++channel) {
+                        uint8_t value = get(i, channel);
+                        if (value == 0)
+                            continue;
+                        set(x, y, z, i, channel, 0);
+                        removeQueue[channel].push_back({ x, y, z, value });
+                    }
+                }
+    }
+    remove(SKY);
+    remove(BLOCK);
+
+    // Re-seed sources inside the boxes, then let the surroundings flood back in
+    for (const VoxelEdit& e : boxes) {
+        for (int z = e.z0; z <= e.z1; ++z)
+            for (int x = e.x0; x <= e.x1; ++x)
+                for (int y = e.y1; y >= e.y0; --y) {
+                    if (!fullSky(vmap.materialAt(x, y, z)))
+                        break;
+                    const bool openAbove = y == vmap.height - 1 ||
+                        get(vmap.cellIndex(x, y + 1, z), SKY) == VOXEL_MAX_LIGHT;
+                    if (!openAbove)
+                        break;
+                    seed(x, y, z, SKY, VOXEL_MAX_LIGHT);
+                }
+
+        for (int z = e.z0; z <= e.z1; ++z)
+            for (int y = e.y0; y <= e.y1; ++y)
+                for (int x = e.x0; x <= e.x1; ++x)
+                    if (emits[vmap.materialAt(x, y, z)])
+                        seed(x, y, z, BLOCK, VOXEL_MAX_LIGHT);
+
+        seedFromShell(e);
+    }
+    propagate(SKY);
+    propagate(BLOCK);
+}
+}
+
+void RelightVoxelMap(VoxelMap& vmap) {
+    LightFlood flood(vmap, false);
+    flood.relightAll();
+
+    for (int cz = 0; cz < vmap.chunksZ(); ++cz)
+        for (int cy = 0; cy < vmap.chunksY(); ++cy)
+            for (int cx = 0; cx < vmap.chunksX(); ++cx)
+                vmap.markChunkDirty(cx, cy, cz);
+}
+
+void UpdateVoxelLight(VoxelMap& vmap) {
+    static std::vector<VoxelEdit> edits;
+    if (!vmap.takeEdits(edits)) {
+        RelightVoxelMap(vmap);
+        return;
+    }
+    if (edits.empty())
+        return;
+
+    LightFlood flood(vmap, true);
+    flood.relightEdits(edits);
+}
+
+void BenchmarkVoxelLighting() {
+    const Voxel stone{ VoxelType::Solid, "voxel_lit" };
+    const Voxel lamp{ VoxelType::Light, "voxel_lit" };
+    std::vector<VoxelEdit> edits;
+
+    auto milliseconds = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::cout << "[Voxel] Lighting benchmark (incremental cost should not grow with the map)" << std::endl;
+    for (int size : { 64, 128, 256 }) {
+        // Terrain slab with a roof over half of it, so both channels have work to do
+        VoxelMap scratch;
+        scratch.layout = VoxelLayout::Cube;
+        scratch.resize(size, 64, size);
+        for (int z = 0; z < size; ++z)
+            for (int y = 0; y < 16; ++y)
+                scratch.fillRow(0, size, y, z, scratch.materialIndex(stone));
+        for (int z = 0; z < size / 2; ++z)
+            scratch.fillRow(0, size, 40, z, scratch.materialIndex(stone));
+        scratch.recountChunks();
+
+        auto start = std::chrono::steady_clock::now();
+        RelightVoxelMap(scratch);
+        double fullMs = milliseconds(start);
+        scratch.takeEdits(edits);
+
+        std::cout << "  " << size << "x64x" << size << ": full relight " << fullMs << " ms" << std::endl;
+        for (int edge : { 1, 4, 16 }) {
+            // Dig a pit under the roof and drop a lamp into it, then fill it back in
+            const int x0 = size / 2 - edge / 2, z0 = size / 4 - edge / 2;
+            const int cells = edge * edge * edge;
+            start = std::chrono::steady_clock::now();
+            for (int z = z0; z < z0 + edge; ++z)
+                for (int y = 16 - edge; y < 16; ++y)
+                    scratch.fillRow(x0, x0 + edge, y, z, 0);
+            scratch.markRegionDirty(x0, 16 - edge, z0, x0 + edge - 1, 15, z0 + edge - 1);
+            scratch.setVoxel(x0, 16 - edge, z0, lamp);
+            UpdateVoxelLight(scratch);
+            for (int z = z0; z < z0 + edge; ++z)
+                for (int y = 16 - edge; y < 16; ++y)
+                    scratch.fillRow(x0, x0 + edge, y, z, scratch.materialIndex(stone));
+            scratch.markRegionDirty(x0, 16 - edge, z0, x0 + edge - 1, 15, z0 + edge - 1);
+            UpdateVoxelLight(scratch);
+            double editMs = milliseconds(start) / 2.0;
+            std::cout << "    edit of " << cells << " cells: " << editMs << " ms per relight" << std::endl;
+        }
+    }
+}
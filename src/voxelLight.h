@@ -0,0 +1,18 @@
+#pragma once
+#include "voxel.h"
+
+// Per-cell sky and block light, flood filled through empty cells. Sky light enters from the top
+// of the map and falls straight down at full strength; both channels lose one level per step
+// sideways (more through water). Light blocks emit full block light.
+constexpr int VOXEL_MAX_LIGHT = 15;
+
+// Recomputes both channels for the whole map
+void RelightVoxelMap(VoxelMap& vmap);
+
+// Applies the edits made since the last call. Light is only removed around the edited cells and
+// flooded back in from the edge of the removed area, so the cost follows the edit size rather
+// than the map size. Chunks whose light changed are marked dirty for remeshing.
+void UpdateVoxelLight(VoxelMap& vmap);
+
+// Times full and incremental relights for several map and edit sizes and prints the results
+void BenchmarkVoxelLighting();
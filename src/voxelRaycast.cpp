@@ -0,0 +1,304 @@
+#include "voxelRaycast.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace {
+const float SQRT3 = 1.7320508f;
+const float INF = std::numeric_limits<float>::infinity();
+
+// Ray/box slab test; returns false when the ray misses the box
+bool IntersectBox(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& boxMin,
+                  const glm::vec3& boxMax, float& tEnter, float& tExit) {
+    tEnter = -INF;
+    tExit = INF;
+    for (int i = 0; i < 3; ++i) {
+        if (direction[i] == 0.0f) {
+            if (origin[i] < boxMin[i] || origin[i] > boxMax[i])
+                return false;
+            continue;
+        }
+        float t0 = (boxMin[i] - origin[i]) / direction[i];
+        float t1 = (boxMax[i] - origin[i]) / direction[i];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+    return tEnter <= tExit;
+}
+
+VoxelRayHit RaycastCube(const VoxelMap& vmap, const glm::vec3& origin, const glm::vec3& direction,
+                        float maxDistance) {
+    VoxelRayHit result;
+    const int dims[3] = { vmap.width, vmap.height, vmap.depth };
+
+    // Grid space: cell i covers [i, i + 1) and t stays in world units
+    const glm::vec3 g = origin / vmap.voxelSize + glm::vec3(0.5f);
+    const glm::vec3 dg = direction / vmap.voxelSize;
+
+    float tEnter, tExit;
+    if (!IntersectBox(g, dg, glm::vec3(0.0f), glm::vec3(dims[0], dims[1], dims[2]), tEnter, tExit))
+        return result;
+    tEnter = std::max(tEnter, 0.0f);
+    tExit = std::min(tExit, maxDistance);
+    if (tEnter > tExit)
+        return result;
+
+    int cell[3], step[3];
+    float tMax[3], tDelta[3];
+    glm::vec3 normal(0.0f);
+    const glm::vec3 entry = g + dg * tEnter;
+    for (int i = 0; i < 3; ++i) {
+        cell[i] = std::clamp(static_cast<int>(std::floor(entry[i])), 0, dims[i] - 1);
+        step[i] = dg[i] > 0.0f ? 1 : (dg[i] < 0.0f ? -1 : 0);
+        tDelta[i] = step[i] != 0 ? std::fabs(1.0f / dg[i]) : INF;
+    }
+    // Entry face of the map box, if the ray starts outside it
+    if (tEnter > 0.0f) {
+        for (int i = 0; i < 3; ++i) {
+            if (step[i] != 0 && std::fabs(g[i] + dg[i] * tEnter - (step[i] > 0 ? 0.0f : dims[i])) < 1e-4f) {
+                normal[i] = static_cast<float>(-step[i]);
+                break;
+            }
+        }
+    }
+
+    auto resetTMax = [&] {
+        for (int i = 0; i < 3; ++i)
+            tMax[i] = step[i] != 0 ? (cell[i] + (step[i] > 0 ? 1 : 0) - g[i]) / dg[i] : INF;
+    };
+    resetTMax();
+
+    int prev[3] = { cell[0], cell[1], cell[2] };
+    float t = tEnter;
+    for (;;) {
+        const int cc[3] = { cell[0] / VOXEL_CHUNK_SIZE, cell[1] / VOXEL_CHUNK_SIZE, cell[2] / VOXEL_CHUNK_SIZE };
+        if (vmap.isChunkEmpty(cc[0], cc[1], cc[2])) {
+            // Jump straight to the chunk boundary the ray leaves through
+            float tLeave = INF;
+            int axis = -1, boundary = 0;
+            for (int i = 0; i < 3; ++i) {
+                if (step[i] == 0)
+                    continue;
+                int b = step[i] > 0 ? std::min((cc[i] + 1) * VOXEL_CHUNK_SIZE, dims[i]) : cc[i] * VOXEL_CHUNK_SIZE;
+                float tb = (b - g[i]) / dg[i];
+                if (tb < tLeave) {
+                    tLeave = tb;
+                    axis = i;
+                    boundary = b;
+                }
+            }
+            if (axis < 0 || tLeave > tExit)
+                return result;
+
+            t = tLeave;
+            const glm::vec3 p = g + dg * t;
+            for (int i = 0; i < 3; ++i) {
+                int lo = cc[i] * VOXEL_CHUNK_SIZE;
+                int hi = std::min(lo + VOXEL_CHUNK_SIZE, dims[i]) - 1;
+                cell[i] = std::clamp(static_cast<int>(std::floor(p[i])), lo, hi);
+            }
+            cell[axis] = step[axis] > 0 ? boundary - 1 : boundary;
+            std::copy(cell, cell + 3, prev);
+            cell[axis] += step[axis];
+            if (cell[axis] < 0 || cell[axis] >= dims[axis])
+                return result;
+            normal = glm::vec3(0.0f);
+            normal[axis] = static_cast<float>(-step[axis]);
+            resetTMax();
+            continue;
+        }
+
+        if (vmap.isSolid(cell[0], cell[1], cell[2])) {
+            result.hit = true;
+            result.x = cell[0]; result.y = cell[1]; result.z = cell[2];
+            result.prevX = prev[0]; result.prevY = prev[1]; result.prevZ = prev[2];
+            result.normal = normal;
+            result.distance = t;
+            return result;
+        }
+
+        int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        if (tMax[axis] > tExit)
+            return result;
+        std::copy(cell, cell + 3, prev);
+        t = tMax[axis];
+        cell[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        normal = glm::vec3(0.0f);
+        normal[axis] = static_cast<float>(-step[axis]);
+        if (cell[axis] < 0 || cell[axis] >= dims[axis])
+            return result;
+    }
+}
+
+VoxelRayHit RaycastHex(const VoxelMap& vmap, const glm::vec3& origin, const glm::vec3& direction,
+                       float maxDistance) {
+    VoxelRayHit result;
+    const float size = vmap.voxelSize;
+    const float radius = size * 0.5f;
+    const float apothem = radius * SQRT3 * 0.5f;
+
+    // Side normals for the three pairs of opposite prism faces (side i faces 30 + 60*i degrees)
+    glm::vec3 sideNormals[HEX_SIDES];
+    for (int i = 0; i < HEX_SIDES; ++i) {
+        float angle = glm::radians(30.0f + 60.0f * i);
+        sideNormals[i] = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+    }
+
+    const glm::vec3 mapMin(-radius, -0.5f * size, -apothem);
+    const glm::vec3 mapMax(1.5f * radius * (vmap.width - 1) + radius, (vmap.height - 0.5f) * size,
+                           SQRT3 * radius * vmap.depth + apothem);
+    float tEnter, tExit;
+    if (!IntersectBox(origin, direction, mapMin, mapMax, tEnter, tExit))
+        return result;
+    tEnter = std::max(tEnter, 0.0f);
+    tExit = std::min(tExit, maxDistance);
+    if (tEnter > tExit)
+        return result;
+
+    float t = tEnter;
+    int x, y, z;
+    vmap.worldToCell(origin + direction * t, x, y, z);
+    int prevX = x, prevY = y, prevZ = z;
+    glm::vec3 normal(0.0f);
+    int skipTried = -1;
+
+    // Each step leaves the current prism through one face, so the walk always moves forward
+    const int maxSteps = 4 * (vmap.width + vmap.height + vmap.depth) + 16;
+    for (int stepCount = 0; stepCount < maxSteps; ++stepCount) {
+        if (vmap.inBounds(x, y, z)) {
+            if (vmap.isSolid(x, y, z)) {
+                result.hit = true;
+                result.x = x; result.y = y; result.z = z;
+                result.prevX = prevX; result.prevY = prevY; result.prevZ = prevZ;
+                result.normal = normal;
+                result.distance = t;
+                return result;
+            }
+
+            const int cx = x / VOXEL_CHUNK_SIZE, cy = y / VOXEL_CHUNK_SIZE, cz = z / VOXEL_CHUNK_SIZE;
+            const int chunk = vmap.chunkIndex(cx, cy, cz);
+            if (chunk != skipTried && vmap.isChunkEmpty(cx, cy, cz)) {
+                // Box fully covered by the chunk's prisms; its zig-zag edges are walked cell by cell
+                const int x0 = cx * VOXEL_CHUNK_SIZE, x1 = std::min(x0 + VOXEL_CHUNK_SIZE, vmap.width);
+                const int y0 = cy * VOXEL_CHUNK_SIZE, y1 = std::min(y0 + VOXEL_CHUNK_SIZE, vmap.height);
+                const int z0 = cz * VOXEL_CHUNK_SIZE, z1 = std::min(z0 + VOXEL_CHUNK_SIZE, vmap.depth);
+                const glm::vec3 innerMin(1.5f * radius * x0 - 0.5f * radius, (y0 - 0.5f) * size, SQRT3 * radius * z0);
+                const glm::vec3 innerMax(1.5f * radius * (x1 - 1) + 0.5f * radius, (y1 - 0.5f) * size,
+                                         SQRT3 * radius * (z1 - 0.5f));
+                float tIn, tOut;
+                bool inside = IntersectBox(origin, direction, innerMin, innerMax, tIn, tOut) && tOut > t;
+                if (!inside || tIn <= t)
+                    skipTried = chunk;  // Otherwise still in the zig-zag edge; try again from the next cell
+                if (inside && tIn <= t) {
+                    // Land just short of the far side so the last step still reports the entry face
+                    float tLand = std::max(t, tOut - 1e-3f * size);
+                    int nx, ny, nz;
+                    vmap.worldToCell(origin + direction * tLand, nx, ny, nz);
+                    if (vmap.inBounds(nx, ny, nz) && !vmap.isSolid(nx, ny, nz)) {
+                        x = nx; y = ny; z = nz;
+                        t = tLand;
+                    }
+                }
+            }
+        }
+
+        // Leave through whichever face the ray reaches first
+        const glm::vec3 center = vmap.cellCenter(x, y, z);
+        const glm::vec3 rel = origin - center;
+        float tNext = INF;
+        int side = -1;
+        for (int k = 0; k < 3; ++k) {
+            float dn = glm::dot(direction, sideNormals[k]);
+            if (dn == 0.0f)
+                continue;
+            float offset = glm::dot(rel, sideNormals[k]);
+            float tk = dn > 0.0f ? (apothem - offset) / dn : (-apothem - offset) / dn;
+            if (tk < tNext) {
+                tNext = tk;
+                side = dn > 0.0f ? k : k + 3;
+            }
+        }
+        if (direction.y != 0.0f) {
+            float ty = direction.y > 0.0f ? (0.5f * size - rel.y) / direction.y : (-0.5f * size - rel.y) / direction.y;
+            if (ty < tNext) {
+                tNext = ty;
+                side = direction.y > 0.0f ? HEX_SIDES : HEX_SIDES + 1;
+            }
+        }
+        if (side < 0 || tNext > tExit)
+            return result;
+
+        prevX = x; prevY = y; prevZ = z;
+        t = std::max(t, tNext);
+        if (side == HEX_SIDES) {
+            ++y;
+            normal = glm::vec3(0.0f, -1.0f, 0.0f);
+        } else if (side == HEX_SIDES + 1) {
+            --y;
+            normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        } else {
+            HexNeighbour(prevX, prevZ, side, x, z);
+            normal = -sideNormals[side];
+        }
+    }
+    return result;
+}
+}
+
+VoxelRayHit RaycastVoxels(const VoxelMap& vmap, const glm::vec3& origin, const glm::vec3& direction,
+                          float maxDistance) {
+    if (vmap.width <= 0 || vmap.height <= 0 || vmap.depth <= 0 || vmap.voxelSize <= 0.0f)
+        return VoxelRayHit{};
+    if (vmap.layout == VoxelLayout::Hex)
+        return RaycastHex(vmap, origin, direction, maxDistance);
+    return RaycastCube(vmap, origin, direction, maxDistance);
+}
+
+void CursorRay(const glm::mat4& view, const glm::mat4& projection, float mouseX, float mouseY,
+               float windowWidth, float windowHeight, glm::vec3& origin, glm::vec3& direction) {
+    const float ndcX = 2.0f * mouseX / windowWidth - 1.0f;
+    const float ndcY = 1.0f - 2.0f * mouseY / windowHeight;
+    const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+void BenchmarkVoxelRaycast(const VoxelMap& vmap) {
+    if (vmap.width <= 0 || vmap.height <= 0 || vmap.depth <= 0) {
+        std::cout << "[Voxel] Raycast benchmark skipped: map is empty" << std::endl;
+        return;
+    }
+
+    // Rays start above the map and aim at random cells, like a cursor looking down at the level
+    const int rayCount = 200000;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pickX(0, vmap.width - 1), pickY(0, vmap.height - 1), pickZ(0, vmap.depth - 1);
+    std::vector<glm::vec3> origins(rayCount), directions(rayCount);
+    const glm::vec3 far = vmap.cellCenter(vmap.width - 1, vmap.height - 1, vmap.depth - 1);
+    const float maxDistance = glm::length(far) * 2.0f + 10.0f * vmap.voxelSize;
+    for (int i = 0; i < rayCount; ++i) {
+        glm::vec3 from = vmap.cellCenter(pickX(rng), 0, pickZ(rng));
+        from.y = far.y + 5.0f * vmap.voxelSize;
+        glm::vec3 to = vmap.cellCenter(pickX(rng), pickY(rng), pickZ(rng));
+        origins[i] = from;
+        directions[i] = glm::normalize(to - from);
+    }
+
+    int hits = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rayCount; ++i)
+        hits += RaycastVoxels(vmap, origins[i], directions[i], maxDistance).hit ? 1 : 0;
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "[Voxel] " << rayCount << " rays in " << seconds * 1000.0 << " ms ("
+              << (seconds > 0.0 ? rayCount / seconds : 0.0) << " rays/s, " << hits << " hits)" << std::endl;
+}
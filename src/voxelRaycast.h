@@ -0,0 +1,25 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "voxel.h"
+
+
+struct VoxelRayHit {
+    bool hit = false;
+    int x = 0, y = 0, z = 0;              // Solid cell that was hit
+    int prevX = 0, prevY = 0, prevZ = 0;  // Cell the ray crossed just before it; new voxels go here
+    glm::vec3 normal{ 0.0f };             // Outward normal of the face the ray entered through
+    float distance = 0.0f;
+};
+
+// Walks the cells along a ray (direction must be normalized) and returns the first solid one.
+// Cube maps use an Amanatides-Woo grid traversal; hex maps step prism to prism through the
+// side the ray leaves by. Chunks with no solid voxels are crossed in a single step.
+VoxelRayHit RaycastVoxels(const VoxelMap& vmap, const glm::vec3& origin, const glm::vec3& direction,
+                          float maxDistance);
+
+// World-space ray through a cursor position given in window coordinates
+void CursorRay(const glm::mat4& view, const glm::mat4& projection, float mouseX, float mouseY,
+               float windowWidth, float windowHeight, glm::vec3& origin, glm::vec3& direction);
+
+// Casts random rays down into the map and prints rays/second
+void BenchmarkVoxelRaycast(const VoxelMap& vmap);
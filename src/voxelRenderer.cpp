@@ -1,34 +1,576 @@
 #include "voxelRenderer.h"
 #include "map.h"
 #include "voxel.h"
+#include "voxelLight.h"
+
+#include "jobSystem.h"
+#include "cpuProfiler.h"
 
-#include "ShapeFactory.h"
 #include <glm/glm.hpp>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+struct CubeFace {
+    int dx, dy, dz;           // Neighbour that hides this face when solid
+    float normal[3];
+    float corners[6][3];      // Two triangles, same winding as createCube
+};
+
+const CubeFace cubeFaces[6] = {
+    { 0, 0, 1,  { 0.0f, 0.0f, 1.0f },
+      { {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f},
+        {-0.5f,-0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f} } },
+    { 0, 0,-1,  { 0.0f, 0.0f,-1.0f },
+      { {-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f},
+        {-0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f} } },
+    {-1, 0, 0,  {-1.0f, 0.0f, 0.0f },
+      { {-0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f},
+        {-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f,-0.5f} } },
+    { 1, 0, 0,  { 1.0f, 0.0f, 0.0f },
+      { { 0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f},
+        { 0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f, 0.5f} } },
+    { 0, 1, 0,  { 0.0f, 1.0f, 0.0f },
+      { {-0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f},
+        {-0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f,-0.5f} } },
+    { 0,-1, 0,  { 0.0f,-1.0f, 0.0f },
+      { {-0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f,-0.5f},
+        {-0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f} } },
+};
+
+// Unit hex prism (radius 0.5, height 1) split into the faces the mesher can drop
+struct HexPrismFaces {
+    float sideNormal[HEX_SIDES][3];
+    float sideCorners[HEX_SIDES][6][3];
+    float topCorners[HEX_SIDES * 3][3];
+    float bottomCorners[HEX_SIDES * 3][3];
+
+    HexPrismFaces() {
+        const float pi = 3.14159265f;
+        float ring[HEX_SIDES][2];
+        for (int i = 0; i < HEX_SIDES; ++i) {
+            float angle = i * pi / 3.0f;  // Corners at 0, 60, ... like createHexPrism
+            ring[i][0] = 0.5f * std::cos(angle);
+            ring[i][1] = 0.5f * std::sin(angle);
+        }
 
-void AddVoxelToMap(const Voxel& voxel, int x, int y, int z, float size, Map& map) {
-    if (voxel.type == VoxelType::Empty)
+        for (int i = 0; i < HEX_SIDES; ++i) {
+            int next = (i + 1) % HEX_SIDES;
+            float normalAngle = pi / 6.0f + i * pi / 3.0f;
+            sideNormal[i][0] = std::cos(normalAngle);
+            sideNormal[i][1] = 0.0f;
+            sideNormal[i][2] = std::sin(normalAngle);
+
+            const float quad[6][3] = {
+                { ring[i][0], -0.5f, ring[i][1] }, { ring[next][0], -0.5f, ring[next][1] }, { ring[next][0], 0.5f, ring[next][1] },
+                { ring[i][0], -0.5f, ring[i][1] }, { ring[next][0],  0.5f, ring[next][1] }, { ring[i][0],    0.5f, ring[i][1] },
+            };
+            std::copy(&quad[0][0], &quad[0][0] + 18, &sideCorners[i][0][0]);
+
+            const float top[3][3] = { { 0.0f, 0.5f, 0.0f }, { ring[i][0], 0.5f, ring[i][1] }, { ring[next][0], 0.5f, ring[next][1] } };
+            const float bottom[3][3] = { { 0.0f, -0.5f, 0.0f }, { ring[next][0], -0.5f, ring[next][1] }, { ring[i][0], -0.5f, ring[i][1] } };
+            std::copy(&top[0][0], &top[0][0] + 9, &topCorners[i * 3][0]);
+            std::copy(&bottom[0][0], &bottom[0][0] + 9, &bottomCorners[i * 3][0]);
+        }
+    }
+};
+
+const HexPrismFaces hexFaces;
+
+// Faces are lit by the cell they look into
+template <size_t N>
+void emitFace(std::vector<float>& out, const glm::vec3& center, float size,
+              const float (&corners)[N][3], const float* normal, uint8_t light) {
+    const float sky = (light >> 4) / static_cast<float>(VOXEL_MAX_LIGHT);
+    const float block = (light & 0x0F) / static_cast<float>(VOXEL_MAX_LIGHT);
+    for (const auto& corner : corners) {
+        out.insert(out.end(), {
+            center.x + corner[0] * size, center.y + corner[1] * size, center.z + corner[2] * size,
+            normal[0], normal[1], normal[2], sky, block
+        });
+    }
+}
+
+void meshCubeCells(const ChunkSnapshot& snapshot, std::vector<std::vector<float>>& scratch) {
+    const float size = snapshot.voxelSize;
+    for (int z = 0; z < snapshot.sizeZ; ++z) {
+        for (int y = 0; y < snapshot.sizeY; ++y) {
+            for (int x = 0; x < snapshot.sizeX; ++x) {
+                uint8_t cell = snapshot.at(x, y, z);
+                if (cell == 0)
+                    continue;
+
+                std::vector<float>& out = scratch[cell - 1];
+                glm::vec3 center(glm::vec3(x * size, y * size, z * size) + snapshot.cellOffset);
+
+                for (const CubeFace& face : cubeFaces) {
+                    if (snapshot.at(x + face.dx, y + face.dy, z + face.dz) != 0)
+                        continue;  // Hidden behind a neighbour
+                    emitFace(out, center, size, face.corners, face.normal,
+                             snapshot.lightAt(x + face.dx, y + face.dy, z + face.dz));
+                }
+            }
+        }
+    }
+}
+
+void meshHexCells(const ChunkSnapshot& snapshot, std::vector<std::vector<float>>& scratch) {
+    static const float up[3] = { 0.0f, 1.0f, 0.0f };
+    static const float down[3] = { 0.0f, -1.0f, 0.0f };
+
+    const float size = snapshot.voxelSize;
+    const float radius = size * 0.5f;
+    for (int z = 0; z < snapshot.sizeZ; ++z) {
+        for (int y = 0; y < snapshot.sizeY; ++y) {
+            for (int x = 0; x < snapshot.sizeX; ++x) {
+                uint8_t cell = snapshot.at(x, y, z);
+                if (cell == 0)
+                    continue;
+
+                std::vector<float>& out = scratch[cell - 1];
+                // Chunk origins are on even columns, so local parity matches the global one
+                glm::vec3 center(x * 1.5f * radius, y * size, 1.7320508f * radius * (z + 0.5f * (x & 1)));
+
+                if (snapshot.at(x, y + 1, z) == 0)
+                    emitFace(out, center, size, hexFaces.topCorners, up, snapshot.lightAt(x, y + 1, z));
+                if (snapshot.at(x, y - 1, z) == 0)
+                    emitFace(out, center, size, hexFaces.bottomCorners, down, snapshot.lightAt(x, y - 1, z));
+
+                for (int side = 0; side < HEX_SIDES; ++side) {
+                    int nx, nz;
+                    HexNeighbour(x, z, side, nx, nz);
+                    if (snapshot.at(nx, y, nz) != 0)
+                        continue;  // Shared with a solid neighbour
+                    emitFace(out, center, size, hexFaces.sideCorners[side], hexFaces.sideNormal[side],
+                             snapshot.lightAt(nx, y, nz));
+                }
+            }
+        }
+    }
+}
+
+// Chunk objects are named "VoxelChunk_cx_cy_cz:<shaderBase>"
+std::string chunkObjectPrefix(int cx, int cy, int cz) {
+    return "VoxelChunk_" + std::to_string(cx) + "_" + std::to_string(cy) + "_" + std::to_string(cz);
+}
+
+struct ChunkMeshResult {
+    int chunkIndex;
+    uint32_t revision;
+    uint32_t generation;
+    int cx, cy, cz;
+    std::vector<ChunkMeshData> groups;
+};
+
+// Edits touching at most this many chunks are meshed on the spot
+constexpr size_t INLINE_REMESH_LIMIT = 8;
+
+MpscQueue<ChunkMeshResult> finishedMeshes;
+std::unordered_map<int, uint32_t> chunkRevisions;  // Latest requested revision per chunk
+uint32_t meshGeneration = 0;                       // Bumped when chunk indices are invalidated
+std::atomic<int> pendingJobs{ 0 };
+
+std::vector<uint8_t> chunkLevels;                // LOD level each chunk is meshed at
+std::unordered_map<int, size_t> chunkTriangles;  // Triangles currently uploaded per chunk
+
+void syncChunkLevels(const VoxelMap& vmap) {
+    size_t count = static_cast<size_t>(vmap.chunksX()) * vmap.chunksY() * vmap.chunksZ();
+    if (chunkLevels.size() != count)
+        chunkLevels.assign(count, 0);
+}
+
+// Sides facing a neighbour drawn at another level; those borders get closed off so no crack
+// opens where the two volumes disagree
+uint8_t openSidesFor(const VoxelMap& vmap, int cx, int cy, int cz) {
+    static const int neighbours[6][4] = {
+        { 1, 0, 0, CHUNK_SIDE_POS_X }, { -1, 0, 0, CHUNK_SIDE_NEG_X }, { 0, 1, 0, CHUNK_SIDE_POS_Y },
+        { 0, -1, 0, CHUNK_SIDE_NEG_Y }, { 0, 0, 1, CHUNK_SIDE_POS_Z }, { 0, 0, -1, CHUNK_SIDE_NEG_Z },
+    };
+    const uint8_t level = chunkLevels[vmap.chunkIndex(cx, cy, cz)];
+    uint8_t sides = 0;
+    for (const auto& n : neighbours) {
+        int nx = cx + n[0], ny = cy + n[1], nz = cz + n[2];
+        if (nx < 0 || ny < 0 || nz < 0 || nx >= vmap.chunksX() || ny >= vmap.chunksY() || nz >= vmap.chunksZ())
+            continue;
+        if (chunkLevels[vmap.chunkIndex(nx, ny, nz)] != level)
+            sides |= n[3];
+    }
+    return sides;
+}
+
+// Removes (and frees) the chunk objects whose prefix is in the set; all of them if the set is null
+void removeChunkObjects(Map& map, const std::unordered_set<std::string>* prefixes) {
+    auto it = std::remove_if(map.objects.begin(), map.objects.end(), [&](Map::MapObject& obj) {
+        if (obj.type != "VoxelChunk")
+            return false;
+        if (prefixes && !prefixes->count(obj.name.substr(0, obj.name.find(':'))))
+            return false;
+        obj.mesh.destroy();
+        return true;
+    });
+    map.objects.erase(it, map.objects.end());
+}
+
+// Swaps the finished meshes into the map with a single pass over its objects
+void uploadChunks(Map& map, const VoxelMap& vmap, std::vector<ChunkMeshResult>& results) {
+    PROFILE_ZONE("Upload Voxel Chunks");
+    if (results.empty())
         return;
 
-    std::string name = "Voxel_" + std::to_string(x) + "_" + std::to_string(y) + "_" + std::to_string(z);
-    std::string type = "HexPrism"; // You can change this based on voxel.type if desired
+    std::unordered_set<std::string> prefixes;
+    for (const auto& result : results)
+        prefixes.insert(chunkObjectPrefix(result.cx, result.cy, result.cz));
+    removeChunkObjects(map, &prefixes);
+
+    for (auto& result : results) {
+        size_t floats = 0;
+        for (const auto& group : result.groups)
+            floats += group.vertices.size();
+        chunkTriangles[result.chunkIndex] = floats / (3 * VOXEL_VERTEX_FLOATS);
+
+        // Vertices are moved into world space so chunks draw with the NO_MODEL shader variant
+        glm::vec3 origin = vmap.cellCenter(result.cx * VOXEL_CHUNK_SIZE, result.cy * VOXEL_CHUNK_SIZE,
+                                           result.cz * VOXEL_CHUNK_SIZE);
+        for (auto& group : result.groups) {
+            for (size_t v = 0; v + 2 < group.vertices.size(); v += VOXEL_VERTEX_FLOATS) {
+                group.vertices[v] += origin.x;
+                group.vertices[v + 1] += origin.y;
+                group.vertices[v + 2] += origin.z;
+            }
+            Map::MapObject obj(chunkObjectPrefix(result.cx, result.cy, result.cz) + ":" + group.shaderBase,
+                               "VoxelChunk", glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f),
+                               group.shaderBase + ".vert", group.shaderBase + ".frag");
+            obj.mesh.setVertices(group.vertices, VOXEL_VERTEX_FLOATS);
+            map.addObjectWithMesh(obj);
+        }
+    }
+}
+
+} // namespace
+
+int voxelUploadBudget = 64;
+bool voxelLodEnabled = true;
+float voxelLodDistance = 24.0f;
+float voxelLodHysteresis = 0.1f;
+
+ChunkSnapshot SnapshotChunk(const VoxelMap& vmap, int cx, int cy, int cz, int lod, uint8_t openSides) {
+    ChunkSnapshot snapshot;
+    snapshot.cx = cx;
+    snapshot.cy = cy;
+    snapshot.cz = cz;
+    snapshot.layout = vmap.layout;
+    snapshot.lod = lod;
+
+    const int scale = 1 << lod;
+    snapshot.voxelSize = vmap.voxelSize * scale;
+    snapshot.cellOffset = 0.5f * (scale - 1) * vmap.voxelSize;
 
-    glm::vec3 position(x * size, y * size, z * size);
-    glm::vec3 rotation(0.0f); // Default rotation
-    glm::vec3 scale(size);    // Uniform scale
+    const int x0 = cx * VOXEL_CHUNK_SIZE;
+    const int y0 = cy * VOXEL_CHUNK_SIZE;
+    const int z0 = cz * VOXEL_CHUNK_SIZE;
+    snapshot.sizeX = (std::min(VOXEL_CHUNK_SIZE, vmap.width - x0) + scale - 1) / scale;
+    snapshot.sizeY = (std::min(VOXEL_CHUNK_SIZE, vmap.height - y0) + scale - 1) / scale;
+    snapshot.sizeZ = (std::min(VOXEL_CHUNK_SIZE, vmap.depth - z0) + scale - 1) / scale;
 
-    std::string vertShader = voxel.shaderBase + ".vert";
-    std::string fragShader = voxel.shaderBase + ".frag";
+    const int P = ChunkSnapshot::PADDED;
+    snapshot.cells.assign(static_cast<size_t>(P) * P * P, 0);
+    snapshot.light.assign(static_cast<size_t>(P) * P * P, 0xF0);  // Open sky outside the map
 
-    Map::MapObject obj(name, type, position, rotation, scale, vertShader, fragShader);
+    // Map palette index -> snapshot shader index + 1, filled in as materials are seen
+    const std::vector<Voxel>& palette = vmap.palette();
+    uint8_t shaderSlot[256] = {};
+    auto slotFor = [&](uint8_t material) {
+        if (shaderSlot[material] == 0) {
+            const std::string& shaderBase = palette[material].shaderBase;
+            auto it = std::find(snapshot.shaderBases.begin(), snapshot.shaderBases.end(), shaderBase);
+            if (it == snapshot.shaderBases.end()) {
+                snapshot.shaderBases.push_back(shaderBase);
+                it = snapshot.shaderBases.end() - 1;
+            }
+            shaderSlot[material] = static_cast<uint8_t>(it - snapshot.shaderBases.begin() + 1);
+        }
+        return shaderSlot[material];
+    };
 
-    map.addObject(obj);
+    // Open sides keep their border row empty
+    const int lxFirst = (openSides & CHUNK_SIDE_NEG_X) ? 0 : -1;
+    const int lxLast = snapshot.sizeX - ((openSides & CHUNK_SIDE_POS_X) ? 1 : 0);
+    const int lyFirst = (openSides & CHUNK_SIDE_NEG_Y) ? 0 : -1;
+    const int lyLast = snapshot.sizeY - ((openSides & CHUNK_SIDE_POS_Y) ? 1 : 0);
+    const int lzFirst = (openSides & CHUNK_SIDE_NEG_Z) ? 0 : -1;
+    const int lzLast = snapshot.sizeZ - ((openSides & CHUNK_SIDE_POS_Z) ? 1 : 0);
+
+    const std::vector<uint8_t>& light = vmap.lightData();
+    if (lod == 0) {
+        // Light covers the whole border, open sides included: faces there still look into it
+        const int lightFirst = std::max(-1, -x0);
+        const int lightLast = std::min(snapshot.sizeX, vmap.width - 1 - x0);
+        for (int lz = -1; lz <= snapshot.sizeZ; ++lz) {
+            for (int ly = -1; ly <= snapshot.sizeY; ++ly) {
+                int y = y0 + ly, z = z0 + lz;
+                if (y < 0 || y >= vmap.height || z < 0 || z >= vmap.depth)
+                    continue;
+                const uint8_t* row = light.data() + vmap.cellIndex(x0, y, z);
+                std::copy(row + lightFirst, row + lightLast + 1,
+                          &snapshot.light[((lz + 1) * P + (ly + 1)) * P + 1 + lightFirst]);
+            }
+        }
+
+        const int rowFirst = std::max(lxFirst, -x0);
+        const int rowLast = std::min(lxLast, vmap.width - 1 - x0);
+        for (int lz = lzFirst; lz <= lzLast; ++lz) {
+            for (int ly = lyFirst; ly <= lyLast; ++ly) {
+                int y = y0 + ly, z = z0 + lz;
+                if (y < 0 || y >= vmap.height || z < 0 || z >= vmap.depth)
+                    continue;
+
+                const uint8_t* row = vmap.rowData(y, z) + x0;
+                uint8_t* out = &snapshot.cells[((lz + 1) * P + (ly + 1)) * P + 1];
+                for (int lx = rowFirst; lx <= rowLast; ++lx) {
+                    if (row[lx] != 0)
+                        out[lx] = slotFor(row[lx]);
+                }
+            }
+        }
+        return snapshot;
+    }
+
+    // Downsampled: each snapshot cell takes the majority of the scale^3 block it covers
+    uint16_t counts[256] = {};
+    std::vector<uint8_t> seen;
+    for (int lz = -1; lz <= snapshot.sizeZ; ++lz) {
+        for (int ly = -1; ly <= snapshot.sizeY; ++ly) {
+            for (int lx = -1; lx <= snapshot.sizeX; ++lx) {
+                const int bx0 = std::max(x0 + lx * scale, 0), bx1 = std::min(x0 + (lx + 1) * scale, vmap.width);
+                const int by0 = std::max(y0 + ly * scale, 0), by1 = std::min(y0 + (ly + 1) * scale, vmap.height);
+                const int bz0 = std::max(z0 + lz * scale, 0), bz1 = std::min(z0 + (lz + 1) * scale, vmap.depth);
+                if (bx0 >= bx1 || by0 >= by1 || bz0 >= bz1)
+                    continue;
+
+                int solid = 0;
+                uint8_t sky = 0, block = 0;
+                for (int z = bz0; z < bz1; ++z) {
+                    for (int y = by0; y < by1; ++y) {
+                        const size_t rowStart = vmap.cellIndex(0, y, z);
+                        const uint8_t* row = vmap.rowData(y, z);
+                        for (int x = bx0; x < bx1; ++x) {
+                            sky = std::max<uint8_t>(sky, light[rowStart + x] & 0xF0);
+                            block = std::max<uint8_t>(block, light[rowStart + x] & 0x0F);
+                            uint8_t material = row[x];
+                            if (material == 0)
+                                continue;
+                            if (counts[material]++ == 0)
+                                seen.push_back(material);
+                            ++solid;
+                        }
+                    }
+                }
+                snapshot.light[((lz + 1) * P + (ly + 1)) * P + (lx + 1)] = sky | block;
+
+                const bool inside = lx >= lxFirst && lx <= lxLast && ly >= lyFirst && ly <= lyLast &&
+                                    lz >= lzFirst && lz <= lzLast;
+                if (solid == 0 || !inside) {
+                    for (uint8_t material : seen)
+                        counts[material] = 0;
+                    seen.clear();
+                    continue;
+                }
+
+                uint8_t best = seen[0];
+                for (uint8_t material : seen) {
+                    if (counts[material] > counts[best])
+                        best = material;
+                    counts[material] = 0;
+                }
+                seen.clear();
+
+                const int total = (bx1 - bx0) * (by1 - by0) * (bz1 - bz0);
+                if (solid * 2 >= total)
+                    snapshot.cells[((lz + 1) * P + (ly + 1)) * P + (lx + 1)] = slotFor(best);
+            }
+        }
+    }
+
+    return snapshot;
 }
 
+std::vector<ChunkMeshData> MeshChunkSnapshot(const ChunkSnapshot& snapshot) {
+    PROFILE_ZONE("Mesh Voxel Chunk");
+    // Each worker keeps its scratch buffers between chunks so meshing does not reallocate
+    thread_local std::vector<std::vector<float>> scratch;
+    scratch.resize(std::max(scratch.size(), snapshot.shaderBases.size()));
+    for (size_t i = 0; i < snapshot.shaderBases.size(); ++i)
+        scratch[i].clear();
+
+    if (snapshot.layout == VoxelLayout::Hex)
+        meshHexCells(snapshot, scratch);
+    else
+        meshCubeCells(snapshot, scratch);
+
+    std::vector<ChunkMeshData> groups;
+    for (size_t i = 0; i < snapshot.shaderBases.size(); ++i) {
+        if (!scratch[i].empty())
+            groups.push_back({ snapshot.shaderBases[i], scratch[i] });  // Copy out at exact size
+    }
+    return groups;
+}
+
+std::vector<ChunkMeshData> BuildChunkMesh(const VoxelMap& vmap, int cx, int cy, int cz) {
+    return MeshChunkSnapshot(SnapshotChunk(vmap, cx, cy, cz));
+}
+
+void UpdateVoxelObjects(VoxelMap& vmap, Map& map) {
+    PROFILE_ZONE("Update Voxel Objects");
+    std::vector<ChunkMeshResult> ready;
+
+    UpdateVoxelLight(vmap);  // Marks the chunks whose light changed, so they are meshed below
+
+    if (vmap.hasDirtyChunks()) {
+        syncChunkLevels(vmap);
+        std::vector<int> dirty = vmap.takeDirtyChunks();
+        const bool meshInline = dirty.size() <= INLINE_REMESH_LIMIT;
+
+        for (int index : dirty) {
+            int cx, cy, cz;
+            vmap.chunkCoords(index, cx, cy, cz);
+            uint32_t revision = ++chunkRevisions[index];  // Anything still in flight is now stale
+            const int level = chunkLevels[index];
+            const uint8_t openSides = openSidesFor(vmap, cx, cy, cz);
+
+            if (meshInline) {
+                ready.push_back({ index, revision, meshGeneration, cx, cy, cz,
+                                  MeshChunkSnapshot(SnapshotChunk(vmap, cx, cy, cz, level, openSides)) });
+                continue;
+            }
+
+            auto snapshot = std::make_shared<ChunkSnapshot>(SnapshotChunk(vmap, cx, cy, cz, level, openSides));
+            uint32_t generation = meshGeneration;
+            ++pendingJobs;
+            GetJobSystem().submit([snapshot, index, revision, generation] {
+                finishedMeshes.push({ index, revision, generation,
+                                      snapshot->cx, snapshot->cy, snapshot->cz,
+                                      MeshChunkSnapshot(*snapshot) });
+                --pendingJobs;
+            });
+        }
+    }
+
+    // Upload worker results on the GL thread, a bounded number per frame
+    ChunkMeshResult result;
+    int budget = voxelUploadBudget;
+    while (budget > 0 && finishedMeshes.pop(result)) {
+        if (result.generation != meshGeneration || result.revision != chunkRevisions[result.chunkIndex])
+            continue;  // Superseded by a newer edit or a resize
+        ready.push_back(std::move(result));
+        --budget;
+    }
+
+    uploadChunks(map, vmap, ready);
+}
+
+void GenerateVoxelObjects(VoxelMap& vmap, Map& map) {
+    PROFILE_ZONE("Generate Voxel Objects");
+    removeChunkObjects(map, nullptr);
+    ++meshGeneration;
+    chunkRevisions.clear();
+    chunkTriangles.clear();
+    syncChunkLevels(vmap);
+    vmap.markAllDirty();
+    UpdateVoxelObjects(vmap, map);
+}
+
+void UpdateVoxelLod(VoxelMap& vmap, const glm::vec3& cameraPosition) {
+    syncChunkLevels(vmap);
+    // The hex layout has no downsampled form yet, so it always stays at full resolution
+    const bool active = voxelLodEnabled && vmap.layout == VoxelLayout::Cube;
+    auto threshold = [](int level) { return voxelLodDistance * static_cast<float>(1 << (level - 1)); };
+
+    for (int index = 0; index < static_cast<int>(chunkLevels.size()); ++index) {
+        int cx, cy, cz;
+        vmap.chunkCoords(index, cx, cy, cz);
+
+        int level = chunkLevels[index];
+        int target = 0;
+        if (active) {
+            const int half = VOXEL_CHUNK_SIZE / 2;
+            glm::vec3 center = vmap.cellCenter(std::min(cx * VOXEL_CHUNK_SIZE + half, vmap.width - 1),
+                                               std::min(cy * VOXEL_CHUNK_SIZE + half, vmap.height - 1),
+                                               std::min(cz * VOXEL_CHUNK_SIZE + half, vmap.depth - 1));
+            float distance = glm::length(center - cameraPosition);
+
+            target = level;
+            while (target + 1 < VOXEL_LOD_LEVELS && distance > threshold(target + 1) * (1.0f + voxelLodHysteresis))
+                ++target;
+            while (target > 0 && distance < threshold(target) * (1.0f - voxelLodHysteresis))
+                --target;
+        }
+        if (target == level)
+            continue;
+
+        // Neighbours are remeshed too: whether they close their shared border depends on this level
+        chunkLevels[index] = static_cast<uint8_t>(target);
+        vmap.markChunkDirty(cx, cy, cz);
+        vmap.markChunkDirty(cx - 1, cy, cz);
+        vmap.markChunkDirty(cx + 1, cy, cz);
+        vmap.markChunkDirty(cx, cy - 1, cz);
+        vmap.markChunkDirty(cx, cy + 1, cz);
+        vmap.markChunkDirty(cx, cy, cz - 1);
+        vmap.markChunkDirty(cx, cy, cz + 1);
+    }
+}
+
+void VoxelLodStats(int chunksPerLevel[VOXEL_LOD_LEVELS], size_t& triangles) {
+    std::fill(chunksPerLevel, chunksPerLevel + VOXEL_LOD_LEVELS, 0);
+    for (uint8_t level : chunkLevels)
+        ++chunksPerLevel[level];
+    triangles = 0;
+    for (const auto& entry : chunkTriangles)
+        triangles += entry.second;
+}
+
+int PendingVoxelChunkJobs() {
+    return pendingJobs.load();
+}
+
+void BenchmarkChunkMeshing(const VoxelMap& vmap) {
+    std::vector<ChunkSnapshot> snapshots;
+    for (int cz = 0; cz < vmap.chunksZ(); ++cz)
+        for (int cy = 0; cy < vmap.chunksY(); ++cy)
+            for (int cx = 0; cx < vmap.chunksX(); ++cx)
+                snapshots.push_back(SnapshotChunk(vmap, cx, cy, cz));
+
+    if (snapshots.empty()) {
+        std::cout << "Chunk meshing benchmark: voxel map is empty, resize it first" << std::endl;
+        return;
+    }
+
+    std::cout << "Chunk meshing benchmark: " << snapshots.size() << " chunks" << std::endl;
+
+    double singleThreadRate = 0.0;
+    for (unsigned threads : BenchmarkThreadCounts()) {
+        JobSystem pool(threads - 1);  // parallelFor runs on the calling thread too
+        std::atomic<size_t> vertexFloats{ 0 };
+
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(static_cast<int>(snapshots.size()), [&](int i) {
+            size_t floats = 0;
+            for (const auto& group : MeshChunkSnapshot(snapshots[i]))
+                floats += group.vertices.size();
+            vertexFloats += floats;
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-void GenerateVoxelObjects(const VoxelMap& vmap, Map& map) {
-    map.clear();
-    for (int z = 0; z < vmap.depth; ++z)
-        for (int y = 0; y < vmap.height; ++y)
-            for (int x = 0; x < vmap.width; ++x)
-                AddVoxelToMap(vmap.voxels[z][y][x], x, y, z, vmap.voxelSize, map);
+        double rate = snapshots.size() / std::max(seconds, 1e-9);
+        if (threads == 1)
+            singleThreadRate = rate;
+        std::cout << "  " << threads << " thread(s): " << static_cast<long long>(rate) << " chunks/s ("
+                  << rate / singleThreadRate << "x), " << vertexFloats / VOXEL_VERTEX_FLOATS << " vertices" << std::endl;
+    }
 }
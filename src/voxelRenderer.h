@@ -1,7 +1,81 @@
 #pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "map.h"  // for Map
 #include "voxel.h"
 
 
-void AddVoxelToMap(const Voxel& voxel, int x, int y, int z, float size, Map& map);
-void GenerateVoxelObjects(const VoxelMap& vmap, Map& map);
+// Vertex data for one chunk, one entry per shader pair used inside it
+struct ChunkMeshData {
+    std::string shaderBase;
+    std::vector<float> vertices;  // 3 pos + 3 normal + sky + block light, relative to the chunk origin
+};
+
+// Floats per chunk vertex; the two light values (0-1) feed attribute 2 of the voxel_lit shader
+constexpr int VOXEL_VERTEX_FLOATS = 8;
+
+// Full resolution plus 2x, 4x and 8x downsampled levels (cube layout only)
+constexpr int VOXEL_LOD_LEVELS = 4;
+
+// Read-only copy of one chunk plus a one-voxel border, so workers never touch the live map
+struct ChunkSnapshot {
+    static constexpr int PADDED = VOXEL_CHUNK_SIZE + 2;
+
+    int cx = 0, cy = 0, cz = 0;
+    int sizeX = 0, sizeY = 0, sizeZ = 0;  // Cells owned by the chunk (smaller at the map edge)
+    int lod = 0;                          // Each cell stands for 2^lod voxels per side
+    float voxelSize = 1.0f;               // Size of one snapshot cell
+    float cellOffset = 0.0f;              // Chunk-local position of cell 0's centre along each axis
+    VoxelLayout layout = VoxelLayout::Cube;
+    std::vector<std::string> shaderBases;  // Palette for the cells below
+    std::vector<uint8_t> cells;            // PADDED^3, 0 = empty, otherwise palette index + 1
+    std::vector<uint8_t> light;            // PADDED^3, packed like VoxelMap::lightAt
+
+    uint8_t at(int lx, int ly, int lz) const {  // Local coords, -1..VOXEL_CHUNK_SIZE
+        return cells[((lz + 1) * PADDED + (ly + 1)) * PADDED + (lx + 1)];
+    }
+    uint8_t lightAt(int lx, int ly, int lz) const {
+        return light[((lz + 1) * PADDED + (ly + 1)) * PADDED + (lx + 1)];
+    }
+};
+
+// Side bits for SnapshotChunk's openSides: the border on that side is left empty so the
+// chunk closes itself off there (used where a neighbour is drawn at a different level)
+enum ChunkSide : uint8_t {
+    CHUNK_SIDE_POS_X = 1, CHUNK_SIDE_NEG_X = 2, CHUNK_SIDE_POS_Y = 4,
+    CHUNK_SIDE_NEG_Y = 8, CHUNK_SIDE_POS_Z = 16, CHUNK_SIDE_NEG_Z = 32
+};
+
+// lod > 0 reduces each 2^lod block to its majority material: solid when at least half the
+// block is solid, using the most common solid material. Light takes the brightest cell of the block.
+ChunkSnapshot SnapshotChunk(const VoxelMap& vmap, int cx, int cy, int cz, int lod = 0, uint8_t openSides = 0);
+// Meshes a snapshot, skipping faces hidden by a solid neighbour (including across chunk borders).
+// Hex cells check their six in-plane neighbours plus the cells above and below.
+std::vector<ChunkMeshData> MeshChunkSnapshot(const ChunkSnapshot& snapshot);
+std::vector<ChunkMeshData> BuildChunkMesh(const VoxelMap& vmap, int cx, int cy, int cz);
+
+// Finished meshes uploaded per frame; the rest wait in the queue for the next frame
+extern int voxelUploadBudget;
+
+// Distance-based level selection. Level n starts at voxelLodDistance * 2^(n-1); a chunk only
+// changes level once it is past the threshold by the hysteresis fraction, so it does not flicker.
+extern bool voxelLodEnabled;
+extern float voxelLodDistance;
+extern float voxelLodHysteresis;
+
+// Picks a level per chunk from the camera position and marks chunks whose level (or whose
+// neighbour's level) changed dirty; UpdateVoxelObjects then meshes them at the new level
+void UpdateVoxelLod(VoxelMap& vmap, const glm::vec3& cameraPosition);
+void VoxelLodStats(int chunksPerLevel[VOXEL_LOD_LEVELS], size_t& triangles);
+
+// Relights the edits made since the last call, then rebuilds the chunk objects marked dirty.
+// Small edits are meshed
+// immediately; larger batches are meshed on worker threads and uploaded over the next frames.
+void UpdateVoxelObjects(VoxelMap& vmap, Map& map);
+// Drops every voxel chunk object from the map and rebuilds all chunks
+void GenerateVoxelObjects(VoxelMap& vmap, Map& map);
+int PendingVoxelChunkJobs();
+
+// Meshes every chunk of the map with 1..N worker threads and prints chunks/second
+void BenchmarkChunkMeshing(const VoxelMap& vmap);
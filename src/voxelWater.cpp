@@ -0,0 +1,422 @@
+#include "voxelWater.h"
+#include "jobSystem.h"
+#include "voxelRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+bool voxelWaterEnabled = true;
+int voxelWaterTickRate = 20;
+
+namespace {
+// Past this many ticks in one frame the backlog is dropped instead of piling up
+constexpr int MAX_TICKS_PER_FRAME = 4;
+
+// What one chunk did during a tick, merged on the calling thread afterwards
+struct ChunkStep {
+    bool changed = false;
+    size_t cellsChanged = 0;
+    std::vector<int> wake;           // Chunks outside this tick's set that water wants to flow into
+    std::vector<glm::ivec3> filled;  // Dry cells that received water
+    std::vector<glm::ivec3> drained; // Water cells that emptied
+};
+
+class WaterSim {
+public:
+    void update(VoxelMap& vmap, float deltaTime);
+    void sync(VoxelMap& vmap);
+    void step(VoxelMap& vmap);
+
+    int activeChunks = 0;
+    size_t cellsChanged = 0;
+    size_t cellsStepped = 0;
+
+private:
+    int width = -1, height = -1, depth = -1;
+    float accumulator = 0.0f;
+    // Double-buffered levels: `level` is the settled state between ticks, `fallen` holds the
+    // state after the falling phase and is only meaningful inside chunks stepped this tick
+    std::vector<uint8_t> level;
+    std::vector<uint8_t> fallen;
+    std::vector<uint8_t> active;   // Per chunk: changed last tick or woken by an edit
+    std::vector<uint8_t> stepped;  // Per chunk: part of the current tick
+    std::vector<int> stepList;
+    std::vector<ChunkStep> results;
+    std::vector<VoxelEdit> edits;
+    bool passable[256] = {};  // Empty or water
+    bool water[256] = {};
+    uint8_t waterMaterial = 0;  // Given to cells water flows into
+
+    void refreshMaterials(const VoxelMap& vmap);
+    void reconcile(const VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1);
+    bool steppedAt(const VoxelMap& vmap, int x, int y, int z) const {
+        return stepped[vmap.chunkIndex(x / VOXEL_CHUNK_SIZE, y / VOXEL_CHUNK_SIZE, z / VOXEL_CHUNK_SIZE)] != 0;
+    }
+    int chunkOf(const VoxelMap& vmap, int x, int y, int z) const {
+        return vmap.chunkIndex(x / VOXEL_CHUNK_SIZE, y / VOXEL_CHUNK_SIZE, z / VOXEL_CHUNK_SIZE);
+    }
+    void fall(const VoxelMap& vmap, int chunk, ChunkStep& out);
+    void spread(const VoxelMap& vmap, int chunk, ChunkStep& out);
+    void apply(VoxelMap& vmap, const ChunkStep& result);
+};
+
+void WaterSim::refreshMaterials(const VoxelMap& vmap) {
+    const std::vector<Voxel>& palette = vmap.palette();
+    for (size_t m = 0; m < 256; ++m) {
+        water[m] = m < palette.size() && palette[m].type == VoxelType::Water;
+        passable[m] = m == 0 || water[m];
+    }
+}
+
+// Brings levels in line with the map inside the box: new water starts full, and cells that are
+// no longer water lose their level. Chunks holding water in the box are woken.
+void WaterSim::reconcile(const VoxelMap& vmap, int x0, int y0, int z0, int x1, int y1, int z1) {
+    x0 = std::max(x0, 0); y0 = std::max(y0, 0); z0 = std::max(z0, 0);
+    x1 = std::min(x1, width - 1); y1 = std::min(y1, height - 1); z1 = std::min(z1, depth - 1);
+    for (int z = z0; z <= z1; ++z) {
+        for (int y = y0; y <= y1; ++y) {
+            const uint8_t* row = vmap.rowData(y, z);
+            uint8_t* levels = level.data() + vmap.cellIndex(0, y, z);
+            for (int x = x0; x <= x1; ++x) {
+                if (!water[row[x]]) {
+                    levels[x] = 0;
+                    continue;
+                }
+                if (levels[x] == 0) {
+                    levels[x] = VOXEL_WATER_MAX_LEVEL;
+                    waterMaterial = row[x];  // Flowing water copies the latest placed material
+                }
+                active[chunkOf(vmap, x, y, z)] = 1;
+            }
+        }
+    }
+}
+
+void WaterSim::sync(VoxelMap& vmap) {
+    refreshMaterials(vmap);
+    const bool resized = width != vmap.width || height != vmap.height || depth != vmap.depth;
+    if (resized) {
+        width = vmap.width;
+        height = vmap.height;
+        depth = vmap.depth;
+        const size_t cells = static_cast<size_t>(width) * height * depth;
+        level.assign(cells, 0);
+        fallen.assign(cells, 0);
+    }
+    const size_t chunks = static_cast<size_t>(vmap.chunksX()) * vmap.chunksY() * vmap.chunksZ();
+    if (active.size() != chunks) {
+        active.assign(chunks, 0);
+        stepped.assign(chunks, 0);
+    }
+
+    if (!vmap.peekEdits(edits) || resized) {
+        reconcile(vmap, 0, 0, 0, width - 1, height - 1, depth - 1);
+        return;
+    }
+    // One cell of margin wakes water next to a removed wall
+    for (const VoxelEdit& edit : edits)
+        reconcile(vmap, edit.x0 - 1, edit.y0 - 1, edit.z0 - 1, edit.x1 + 1, edit.y1 + 1, edit.z1 + 1);
+}
+
+// Falling phase: each cell passes as much water to the cell below as it can hold. Both cells of a
+// pair compute the same amount, so every cell only writes its own entry in `fallen`.
+void WaterSim::fall(const VoxelMap& vmap, int chunk, ChunkStep& out) {
+    int cx, cy, cz;
+    vmap.chunkCoords(chunk, cx, cy, cz);
+    const int x0 = cx * VOXEL_CHUNK_SIZE, x1 = std::min(x0 + VOXEL_CHUNK_SIZE, width);
+    const int y0 = cy * VOXEL_CHUNK_SIZE, y1 = std::min(y0 + VOXEL_CHUNK_SIZE, height);
+    const int z0 = cz * VOXEL_CHUNK_SIZE, z1 = std::min(z0 + VOXEL_CHUNK_SIZE, depth);
+
+    for (int z = z0; z < z1; ++z) {
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* row = vmap.rowData(y, z);
+            const uint8_t* below = y > 0 ? vmap.rowData(y - 1, z) : nullptr;
+            const uint8_t* above = y + 1 < height ? vmap.rowData(y + 1, z) : nullptr;
+            const size_t rowStart = vmap.cellIndex(0, y, z);
+
+            for (int x = x0; x < x1; ++x) {
+                const size_t i = rowStart + x;
+                if (!passable[row[x]]) {
+                    fallen[i] = 0;
+                    continue;
+                }
+
+                const int l = level[i];
+                int down = 0, in = 0;
+                if (below && passable[below[x]] && l > 0) {
+                    down = std::min(l, VOXEL_WATER_MAX_LEVEL - level[i - width]);
+                    if (down > 0 && y == y0 && !steppedAt(vmap, x, y - 1, z)) {
+                        out.wake.push_back(chunkOf(vmap, x, y - 1, z));
+                        down = 0;  // The other side is not stepped; try again next tick
+                    }
+                }
+                if (above && passable[above[x]] && level[i + width] > 0) {
+                    in = std::min<int>(level[i + width], VOXEL_WATER_MAX_LEVEL - l);
+                    if (in > 0 && y == y1 - 1 && !steppedAt(vmap, x, y + 1, z)) {
+                        out.wake.push_back(chunkOf(vmap, x, y + 1, z));
+                        in = 0;
+                    }
+                }
+                fallen[i] = static_cast<uint8_t>(l - down + in);
+            }
+        }
+    }
+}
+
+// Spreading phase: resting water evens out with its horizontal neighbours, moving 1/(sides+1) of
+// the difference per tick. Water with room below it is still falling and does not spread.
+void WaterSim::spread(const VoxelMap& vmap, int chunk, ChunkStep& out) {
+    int cx, cy, cz;
+    vmap.chunkCoords(chunk, cx, cy, cz);
+    const int x0 = cx * VOXEL_CHUNK_SIZE, x1 = std::min(x0 + VOXEL_CHUNK_SIZE, width);
+    const int y0 = cy * VOXEL_CHUNK_SIZE, y1 = std::min(y0 + VOXEL_CHUNK_SIZE, height);
+    const int z0 = cz * VOXEL_CHUNK_SIZE, z1 = std::min(z0 + VOXEL_CHUNK_SIZE, depth);
+    const bool hex = vmap.layout == VoxelLayout::Hex;
+    const int sides = hex ? HEX_SIDES : 4;
+    static const int cubeSides[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    // Water rests on the map floor, on a wall or on a full cell. A cell below in a chunk outside
+    // the tick did not move, so its settled level is current.
+    auto resting = [&](int x, int y, int z, size_t i) {
+        if (y == 0 || !passable[vmap.materialAt(x, y - 1, z)])
+            return true;
+        const bool current = y % VOXEL_CHUNK_SIZE != 0 || steppedAt(vmap, x, y - 1, z);
+        return (current ? fallen[i - width] : level[i - width]) == VOXEL_WATER_MAX_LEVEL;
+    };
+
+    for (int z = z0; z < z1; ++z) {
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* row = vmap.rowData(y, z);
+            const size_t rowStart = vmap.cellIndex(0, y, z);
+
+            for (int x = x0; x < x1; ++x) {
+                if (!passable[row[x]])
+                    continue;
+
+                const size_t i = rowStart + x;
+                const int l = fallen[i];
+                int delta = 0;
+                const bool restingHere = l > 0 && resting(x, y, z, i);
+
+                for (int side = 0; side < sides; ++side) {
+                    int nx, nz;
+                    if (hex) {
+                        HexNeighbour(x, z, side, nx, nz);
+                    } else {
+                        nx = x + cubeSides[side][0];
+                        nz = z + cubeSides[side][1];
+                    }
+                    if (nx < 0 || nz < 0 || nx >= width || nz >= depth || !passable[vmap.materialAt(nx, y, nz)])
+                        continue;
+
+                    const bool inside = nx >= x0 && nx < x1 && nz >= z0 && nz < z1;
+                    const bool neighbourStepped = inside || steppedAt(vmap, nx, y, nz);
+                    const size_t j = vmap.cellIndex(nx, y, nz);
+                    if (!neighbourStepped) {
+                        // Its side of the pair is not computed this tick, so leave the pair alone
+                        if (std::abs(level[j] - l) > sides)
+                            out.wake.push_back(chunkOf(vmap, nx, y, nz));
+                        continue;
+                    }
+
+                    // The higher cell of the pair decides, so both sides agree on the flow
+                    const int ln = fallen[j];
+                    if (l > ln && restingHere)
+                        delta -= (l - ln) / (sides + 1);
+                    else if (ln > l && resting(nx, y, nz, j))
+                        delta += (ln - l) / (sides + 1);
+                }
+
+                const int oldLevel = level[i];
+                const int newLevel = l + delta;
+                if (newLevel == oldLevel)
+                    continue;
+                out.changed = true;
+                ++out.cellsChanged;
+                if (oldLevel == 0)
+                    out.filled.push_back(glm::ivec3(x, y, z));
+                else if (newLevel == 0)
+                    out.drained.push_back(glm::ivec3(x, y, z));
+                level[i] = static_cast<uint8_t>(newLevel);
+            }
+        }
+    }
+}
+
+// Writes the cells that turned wet or dry back into the map, as one edit per chunk
+void WaterSim::apply(VoxelMap& vmap, const ChunkStep& result) {
+    if (result.filled.empty() && result.drained.empty())
+        return;
+    if (waterMaterial == 0 || !water[waterMaterial]) {
+        waterMaterial = vmap.materialIndex(Voxel{ VoxelType::Water, "voxel_lit" });
+        water[waterMaterial] = passable[waterMaterial] = true;
+    }
+
+    glm::ivec3 lo(width, height, depth), hi(-1);
+    for (const glm::ivec3& c : result.filled) {
+        vmap.fillRow(c.x, c.x + 1, c.y, c.z, waterMaterial);
+        lo = glm::min(lo, c);
+        hi = glm::max(hi, c);
+    }
+    for (const glm::ivec3& c : result.drained) {
+        vmap.fillRow(c.x, c.x + 1, c.y, c.z, 0);
+        lo = glm::min(lo, c);
+        hi = glm::max(hi, c);
+    }
+    vmap.markRegionDirty(lo.x, lo.y, lo.z, hi.x, hi.y, hi.z);
+}
+
+void WaterSim::step(VoxelMap& vmap) {
+    // Step the active chunks plus their neighbours, so flows out of an active chunk have both
+    // ends inside the tick
+    static const int offsets[7][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 },
+                                       { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    std::fill(stepped.begin(), stepped.end(), 0);
+    stepList.clear();
+    for (int index = 0; index < static_cast<int>(active.size()); ++index) {
+        if (!active[index])
+            continue;
+        int cx, cy, cz;
+        vmap.chunkCoords(index, cx, cy, cz);
+        for (const auto& o : offsets) {
+            int nx = cx + o[0], ny = cy + o[1], nz = cz + o[2];
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= vmap.chunksX() || ny >= vmap.chunksY() || nz >= vmap.chunksZ())
+                continue;
+            int n = vmap.chunkIndex(nx, ny, nz);
+            if (!stepped[n]) {
+                stepped[n] = 1;
+                stepList.push_back(n);
+            }
+        }
+    }
+    std::fill(active.begin(), active.end(), 0);
+
+    results.assign(stepList.size(), ChunkStep());
+    const int count = static_cast<int>(stepList.size());
+    GetJobSystem().parallelFor(count, [&](int i) { fall(vmap, stepList[i], results[i]); });
+    GetJobSystem().parallelFor(count, [&](int i) { spread(vmap, stepList[i], results[i]); });
+
+    activeChunks = 0;
+    cellsChanged = 0;
+    cellsStepped = stepList.size() * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE;
+    for (int i = 0; i < count; ++i) {
+        const ChunkStep& result = results[i];
+        if (result.changed)
+            active[stepList[i]] = 1;
+        for (int chunk : result.wake)
+            active[chunk] = 1;
+        cellsChanged += result.cellsChanged;
+        apply(vmap, result);
+    }
+    for (uint8_t flag : active)
+        activeChunks += flag;
+}
+
+void WaterSim::update(VoxelMap& vmap, float deltaTime) {
+    sync(vmap);
+    if (!voxelWaterEnabled || vmap.chunksX() == 0 || vmap.chunksY() == 0 || vmap.chunksZ() == 0) {
+        accumulator = 0.0f;
+        return;
+    }
+
+    const float tick = 1.0f / std::max(voxelWaterTickRate, 1);
+    accumulator += deltaTime;
+    int ticks = 0;
+    while (accumulator >= tick && ticks < MAX_TICKS_PER_FRAME) {
+        step(vmap);
+        accumulator -= tick;
+        ++ticks;
+    }
+    if (ticks == MAX_TICKS_PER_FRAME)
+        accumulator = 0.0f;
+}
+
+WaterSim editorWater;
+
+} // namespace
+
+void UpdateVoxelWater(VoxelMap& vmap, float deltaTime) {
+    editorWater.update(vmap, deltaTime);
+}
+
+void VoxelWaterStats(int& activeChunks, size_t& cellsChanged) {
+    activeChunks = editorWater.activeChunks;
+    cellsChanged = editorWater.cellsChanged;
+}
+
+void BenchmarkVoxelWater() {
+    const Voxel stone{ VoxelType::Solid, "voxel_lit" };
+    const Voxel water{ VoxelType::Water, "voxel_lit" };
+    const int ticks = 200;
+    std::vector<VoxelEdit> edits;
+
+    std::cout << "[Voxel] Water benchmark, " << ticks << " ticks on "
+              << GetJobSystem().threadCount() << " worker thread(s)" << std::endl;
+    for (VoxelLayout layout : { VoxelLayout::Cube, VoxelLayout::Hex }) {
+        // Second pass queues remeshing of every chunk the water touched, as the editor does,
+        // so the ticks share the job system with a meshing backlog
+        for (bool meshing : { false, true }) {
+            // A floor with a tall block of water dropped onto it
+            VoxelMap scratch;
+            scratch.layout = layout;
+            scratch.resize(128, 48, 128);
+            for (int z = 0; z < scratch.depth; ++z)
+                scratch.fillRow(0, scratch.width, 0, z, scratch.materialIndex(stone));
+            for (int z = 52; z < 76; ++z)
+                for (int y = 24; y < 40; ++y)
+                    scratch.fillRow(52, 76, y, z, scratch.materialIndex(water));
+            scratch.recountChunks();
+            scratch.markAllDirty();
+
+            WaterSim sim;
+            sim.sync(scratch);
+            scratch.takeEdits(edits);
+            scratch.takeDirtyChunks();
+
+            size_t stepped = 0, changed = 0, meshJobs = 0;
+            int peakChunks = 0;
+            double worstTick = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < ticks; ++t) {
+                auto tickStart = std::chrono::steady_clock::now();
+                sim.step(scratch);
+                worstTick = std::max(worstTick, std::chrono::duration<double>(
+                                                    std::chrono::steady_clock::now() - tickStart).count());
+                scratch.takeEdits(edits);  // Nothing consumes the log here; keep it from overflowing
+                std::vector<int> dirty = scratch.takeDirtyChunks();
+                if (meshing) {
+                    for (int index : dirty) {
+                        int cx, cy, cz;
+                        scratch.chunkCoords(index, cx, cy, cz);
+                        auto snapshot = std::make_shared<ChunkSnapshot>(SnapshotChunk(scratch, cx, cy, cz));
+                        GetJobSystem().submit([snapshot] { MeshChunkSnapshot(*snapshot); });
+                    }
+                    meshJobs += dirty.size();
+                }
+                stepped += sim.cellsStepped;
+                changed += sim.cellsChanged;
+                peakChunks = std::max(peakChunks, sim.activeChunks);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            GetJobSystem().wait();
+
+            size_t wet = 0;
+            for (int z = 0; z < scratch.depth; ++z)
+                for (int y = 0; y < scratch.height; ++y)
+                    for (int x = 0; x < scratch.width; ++x)
+                        wet += scratch.getVoxel(x, y, z).type == VoxelType::Water;
+
+            std::cout << "  " << (layout == VoxelLayout::Hex ? "Hex" : "Cube")
+                      << (meshing ? " while meshing: " : ": ")
+                      << seconds * 1000.0 / ticks << " ms/tick, worst " << worstTick * 1000.0 << " ms, "
+                      << static_cast<long long>(stepped / std::max(seconds, 1e-9)) << " cells updated/s, "
+                      << static_cast<long long>(changed / std::max(seconds, 1e-9)) << " levels changed/s, peak "
+                      << peakChunks << " active chunks, " << wet << " water cells at the end";
+            if (meshing)
+                std::cout << ", " << meshJobs << " mesh jobs queued";
+            std::cout << std::endl;
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include "voxel.h"
+
+// Cellular water for VoxelType::Water. Every water cell holds a fill level; each tick water
+// first falls into the cell below as far as it fits, then evens out with its horizontal
+// neighbours. Only chunks that changed last tick (and their neighbours) are stepped, on the
+// job system, reading one level buffer and writing the other. Cells that fill up or drain
+// become water or empty in the map and their chunks are remeshed and relit.
+constexpr int VOXEL_WATER_MAX_LEVEL = 255;  // A full cell; placed water starts full
+
+extern bool voxelWaterEnabled;
+extern int voxelWaterTickRate;  // Ticks per second
+
+// Picks up edits made since the last frame (placed water, removed walls) and runs the ticks due
+// for deltaTime. Call once per frame before UpdateVoxelObjects, which consumes the edit log.
+void UpdateVoxelWater(VoxelMap& vmap, float deltaTime);
+void VoxelWaterStats(int& activeChunks, size_t& cellsChanged);  // Last tick
+
+// Floods scratch maps for a fixed number of ticks and prints cells updated per second
+void BenchmarkVoxelWater();
@@ -0,0 +1,276 @@
+// Headless checks for code that needs no window or GL context. Each test is registered with
+// CTest by name (see CMakeLists.txt); run without arguments to run them all.
+#include "mazeAlgorithms.h"
+#include "mazeGen.h"
+#include "voxel.h"
+#include "voxelFile.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// A perfect maze has exactly one path between any two cells: every cell is reachable from
+// (0, 0) and there are exactly cells - 1 open inner walls
+bool isPerfectMaze(const MazeGrid& grid) {
+    const int w = grid.width(), d = grid.depth();
+    size_t open = 0;
+    for (int z = 0; z < d; ++z)
+        for (int x = 1; x < w; ++x)
+            open += !grid.verticalWall(x, z);
+    for (int z = 1; z < d; ++z)
+        for (int x = 0; x < w; ++x)
+            open += !grid.horizontalWall(x, z);
+    if (open != static_cast<size_t>(w) * d - 1)
+        return false;
+
+    static const int dx[4] = { 0, 1, 0, -1 }, dz[4] = { -1, 0, 1, 0 };
+    std::vector<uint8_t> seen(static_cast<size_t>(w) * d, 0);
+    std::vector<int> stack{ 0 };
+    seen[0] = 1;
+    size_t reached = 1;
+    while (!stack.empty()) {
+        const int cell = stack.back();
+        stack.pop_back();
+        const int x = cell % w, z = cell / w;
+        for (int dir = 0; dir < 4; ++dir) {
+            const int nx = x + dx[dir], nz = z + dz[dir];
+            if (nx < 0 || nz < 0 || nx >= w || nz >= d || grid.hasWall(x, z, dir))
+                continue;
+            const int next = nz * w + nx;
+            if (!seen[next]) {
+                seen[next] = 1;
+                ++reached;
+                stack.push_back(next);
+            }
+        }
+    }
+    return reached == seen.size();
+}
+
+void testMazeSeed() {
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    for (int algorithm = 0; algorithm < static_cast<int>(algorithms.size()); ++algorithm) {
+        const std::string name = algorithms[algorithm]->name();
+        for (uint32_t seed : { 1u, 12345u }) {
+            MazeGrid first = CarveMazeGrid(61, 37, false, seed, algorithm);
+            MazeGrid second = CarveMazeGrid(61, 37, false, seed, algorithm);
+            check(first == second, name + ": seed " + std::to_string(seed) + " gives the same maze twice");
+            check(isPerfectMaze(first), name + ": seed " + std::to_string(seed) + " carves a perfect maze");
+
+            // Open spaces draw from the same generator, so they repeat too
+            check(CarveMazeGrid(61, 37, true, seed, algorithm) == CarveMazeGrid(61, 37, true, seed, algorithm),
+                  name + ": seed " + std::to_string(seed) + " with open spaces gives the same maze twice");
+        }
+        check(!(CarveMazeGrid(61, 37, false, 1u, algorithm) == CarveMazeGrid(61, 37, false, 2u, algorithm)),
+              name + ": different seeds give different mazes");
+    }
+    check(isPerfectMaze(CarveMazeGrid(1, 1, false, 7u)), "a single cell is a perfect maze");
+}
+
+// Floor cells and wall segments covered by a box list, counted per unit of the maze grid.
+// Anything that lands outside the grid is counted in outside.
+struct MazeCoverage {
+    std::vector<int> floor, widthWalls, depthWalls;
+    size_t outside = 0;
+};
+
+MazeCoverage rasterizeBoxes(const std::vector<MazeBox>& boxes, int width, int depth, float cs) {
+    MazeCoverage coverage;
+    coverage.floor.assign(static_cast<size_t>(width) * depth, 0);
+    coverage.widthWalls.assign(static_cast<size_t>(width) * (depth + 1), 0);
+    coverage.depthWalls.assign(static_cast<size_t>(width + 1) * depth, 0);
+    const float minX = -(width * cs) / 2.0f, minZ = -(depth * cs) / 2.0f;
+    auto toCell = [&](float value) { return static_cast<int>(std::lround(value / cs)); };
+    auto mark = [&](std::vector<int>& units, int x, int z, int rowLength, int rows) {
+        if (x < 0 || z < 0 || x >= rowLength || z >= rows)
+            ++coverage.outside;
+        else
+            ++units[static_cast<size_t>(z) * rowLength + x];
+    };
+
+    for (const MazeBox& box : boxes) {
+        const int x0 = toCell(box.position.x - box.scale.x / 2.0f - minX), x1 = x0 + toCell(box.scale.x);
+        const int z0 = toCell(box.position.z - box.scale.z / 2.0f - minZ), z1 = z0 + toCell(box.scale.z);
+        if (box.type == "Floor") {
+            for (int z = z0; z < z1; ++z)
+                for (int x = x0; x < x1; ++x)
+                    mark(coverage.floor, x, z, width, depth);
+        } else if (box.type == "WidthWall") {
+            const int line = toCell(box.position.z - minZ);
+            for (int x = x0; x < x1; ++x)
+                mark(coverage.widthWalls, x, line, width, depth + 1);
+        } else {
+            const int line = toCell(box.position.x - minX);
+            for (int z = z0; z < z1; ++z)
+                mark(coverage.depthWalls, line, z, width + 1, depth);
+        }
+    }
+    return coverage;
+}
+
+// Every unit the reference covers is covered exactly once by the merged boxes, and nothing else
+bool sameCoverage(const std::vector<int>& reference, const std::vector<int>& merged) {
+    for (size_t i = 0; i < reference.size(); ++i) {
+        if (merged[i] != (reference[i] > 0 ? 1 : 0))
+            return false;
+    }
+    return true;
+}
+
+void testMazeMerging() {
+    const int width = 53, depth = 41;
+    const std::vector<const MazeAlgorithm*>& algorithms = MazeAlgorithms();
+    for (int algorithm = 0; algorithm < static_cast<int>(algorithms.size()); ++algorithm) {
+        for (bool openSpaces : { false, true }) {
+            const MazeGrid grid = CarveMazeGrid(width, depth, openSpaces, 12345u, algorithm);
+
+            // Holes in the floor, as left above a stairwell, must stay holes after merging
+            std::vector<uint8_t> floorCells(static_cast<size_t>(width) * depth, 1);
+            for (size_t i = 0; i < floorCells.size(); i += 7)
+                floorCells[i] = 0;
+
+            const std::vector<uint8_t>* floors[] = { nullptr, &floorCells };
+
+            for (float cellSize : { 1.0f, 2.5f }) {
+                for (const std::vector<uint8_t>* floor : floors) {
+                    const MazeCoverage reference =
+                        rasterizeBoxes(BuildMazeBoxes(grid, cellSize, 0.0f, false, floor), width, depth, cellSize);
+                    const MazeCoverage merged =
+                        rasterizeBoxes(BuildMazeBoxes(grid, cellSize, 0.0f, true, floor), width, depth, cellSize);
+                    const std::string what = std::string(algorithms[algorithm]->name()) +
+                                             (openSpaces ? " with open spaces" : "") + ", cell size " +
+                                             std::to_string(cellSize) + (floor ? ", floor holes" : "");
+                    check(reference.outside == 0 && merged.outside == 0, what + ": boxes stay inside the grid");
+                    check(sameCoverage(reference.floor, merged.floor), what + ": merged floor matches per-cell floor");
+                    check(sameCoverage(reference.widthWalls, merged.widthWalls) &&
+                              sameCoverage(reference.depthWalls, merged.depthWalls),
+                          what + ": merged walls match per-segment walls");
+                }
+            }
+        }
+    }
+}
+
+void testVoxelRoundTrip() {
+    const Voxel materials[] = { { VoxelType::Solid, "voxel_lit" }, { VoxelType::Floor, "basic" },
+                                { VoxelType::Water, "voxel_lit" }, { VoxelType::Light, "voxel_lit" } };
+    const std::string path = (std::filesystem::temp_directory_path() / "editor_tests_roundtrip.lvox").string();
+
+    for (VoxelLayout layout : { VoxelLayout::Cube, VoxelLayout::Hex }) {
+        const std::string name = layout == VoxelLayout::Hex ? "hex" : "cube";
+
+        // A solid bottom chunk layer (run-length), noise above part of it (bit-packed) and empty
+        // chunks elsewhere; the size is not a chunk multiple, so edge chunks are partial
+        VoxelMap source;
+        source.layout = layout;
+        source.voxelSize = 0.75f;
+        source.resize(45, 37, 50);
+        uint8_t indices[4];
+        for (int i = 0; i < 4; ++i)
+            indices[i] = source.materialIndex(materials[i]);
+        for (int z = 0; z < source.depth; ++z) {
+            for (int y = 0; y < VOXEL_CHUNK_SIZE; ++y)
+                source.fillRow(0, source.width, y, z, indices[0]);
+            for (int y = VOXEL_CHUNK_SIZE; y < 2 * VOXEL_CHUNK_SIZE; ++y)
+                for (int x = 0; x < 2 * VOXEL_CHUNK_SIZE; ++x) {
+                    uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^
+                                    static_cast<uint32_t>(z) * 83492791u;
+                    hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+                    const uint32_t pick = (hash >> 16) % 5;
+                    if (pick < 4)
+                        source.fillRow(x, x + 1, y, z, indices[pick]);
+                }
+        }
+        source.recountChunks();
+
+        check(source.saveToFile(path), name + ": save succeeds");
+        int encodings[3] = { 0, 0, 0 };
+        VoxelFileReader reader;
+        check(reader.open(path), name + ": reader opens the saved file");
+        for (int cz = 0; cz < reader.chunksZ(); ++cz)
+            for (int cy = 0; cy < reader.chunksY(); ++cy)
+                for (int cx = 0; cx < reader.chunksX(); ++cx)
+                    ++encodings[static_cast<int>(reader.chunkEncoding(cx, cy, cz))];
+        reader.close();
+        check(encodings[0] > 0 && encodings[1] > 0 && encodings[2] > 0,
+              name + ": file has empty, run-length and bit-packed chunks");
+
+        VoxelMap loaded;
+        check(loaded.loadFromFile(path), name + ": load succeeds");
+        check(loaded.width == source.width && loaded.height == source.height && loaded.depth == source.depth,
+              name + ": dimensions survive");
+        check(loaded.voxelSize == source.voxelSize, name + ": voxel size survives");
+        check(loaded.layout == source.layout, name + ": layout survives");
+        bool samePalette = loaded.palette().size() == source.palette().size();
+        for (size_t i = 0; samePalette && i < source.palette().size(); ++i)
+            samePalette = loaded.palette()[i].type == source.palette()[i].type &&
+                          loaded.palette()[i].shaderBase == source.palette()[i].shaderBase;
+        check(samePalette, name + ": palette survives");
+        bool sameCells = samePalette && loaded.width == source.width && loaded.height == source.height &&
+                         loaded.depth == source.depth;
+        for (int z = 0; sameCells && z < source.depth; ++z)
+            for (int y = 0; sameCells && y < source.height; ++y)
+                for (int x = 0; sameCells && x < source.width; ++x)
+                    sameCells = loaded.materialAt(x, y, z) == source.materialAt(x, y, z);
+        check(sameCells, name + ": every cell survives");
+
+        // A truncated file is rejected and leaves the map it was loaded into untouched
+        std::vector<char> bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        bytes.resize(bytes.size() / 2);
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        check(!loaded.loadFromFile(path), name + ": truncated file is rejected");
+        check(loaded.width == source.width && loaded.materialAt(0, 0, 0) == source.materialAt(0, 0, 0),
+              name + ": failed load keeps the previous map");
+    }
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+const Test tests[] = {
+    { "maze_seed", testMazeSeed },
+    { "maze_merging", testMazeMerging },
+    { "voxel_round_trip", testVoxelRoundTrip },
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool found = false;
+    for (const Test& test : tests) {
+        if (argc > 1 && std::strcmp(argv[1], test.name) != 0)
+            continue;
+        found = true;
+        const int before = failures;
+        test.run();
+        std::cout << (failures == before ? "PASS " : "FAIL ") << test.name << std::endl;
+    }
+    if (!found) {
+        std::cerr << "Unknown test: " << argv[1] << std::endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}